@@ -0,0 +1,304 @@
+// Compares the two terrain collision paths: the BVH triangle mesh chunks used to be built with, and the
+// btHeightfieldTerrainShape behind scene::physics::HeightfieldShape. Exits non-zero if the two surfaces disagree by
+// more than SURFACE_TOLERANCE anywhere they're sampled.
+//
+// usage: collision_bench [seed] [radius] [cars] [steps]
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+// bullet
+#include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+
+// glm
+#include <glm/gtc/constants.hpp>
+
+// project - generator
+#include <infd/generator/ChunkGenerator.hpp>
+#include <infd/generator/Heightfield.hpp>
+#include <infd/generator/PerlinNoise.hpp>
+#include <infd/generator/meshbuilding/PerlinMesh.hpp>
+
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // matches Application::WORLD_SCALE
+    const float WORLD_SCALE = 300.f;
+    const float TIME_STEP = 1.f / 60.f;
+    // Largest ray hit difference between the two shapes, in world units, before they count as different surfaces.
+    const float SURFACE_TOLERANCE = 0.01f;
+
+    struct Chunk {
+        int x;
+        int y;
+        infd::generator::Heightfield heightfield;
+    };
+
+    // One static body per chunk, in a world of its own.
+    struct Terrain {
+        std::unique_ptr<btDefaultCollisionConfiguration> configuration{new btDefaultCollisionConfiguration()};
+        std::unique_ptr<btCollisionDispatcher> dispatcher{new btCollisionDispatcher(configuration.get())};
+        std::unique_ptr<btDbvtBroadphase> broadphase{new btDbvtBroadphase()};
+        std::unique_ptr<btSequentialImpulseConstraintSolver> solver{new btSequentialImpulseConstraintSolver()};
+        std::unique_ptr<btDiscreteDynamicsWorld> world{
+            new btDiscreteDynamicsWorld(dispatcher.get(), broadphase.get(), solver.get(), configuration.get())
+        };
+
+        std::vector<std::unique_ptr<btTriangleMesh>> meshes;
+        std::vector<std::vector<float>> heights;
+        std::vector<std::unique_ptr<btCollisionShape>> shapes;
+        std::vector<std::unique_ptr<btRigidBody>> bodies;
+
+        Terrain() {
+            world->setGravity({0, -9.8f, 0});
+        }
+
+        ~Terrain() {
+            for (auto& body : bodies) world->removeRigidBody(body.get());
+        }
+
+        btRigidBody& add(btCollisionShape& shape, const btVector3& position, btScalar mass = 0) {
+            btVector3 inertia(0, 0, 0);
+            if (mass != 0) shape.calculateLocalInertia(mass, inertia);
+
+            btRigidBody::btRigidBodyConstructionInfo info(mass, nullptr, &shape, inertia);
+            info.m_startWorldTransform.setOrigin(position);
+
+            bodies.emplace_back(new btRigidBody(info));
+            world->addRigidBody(bodies.back().get());
+            return *bodies.back();
+        }
+    };
+
+    std::unique_ptr<btBvhTriangleMeshShape> buildBvh(Terrain& terrain, const Chunk& chunk) {
+        terrain.meshes.push_back(infd::generator::meshbuilding::generateTerrainCollision(chunk.heightfield));
+        return std::make_unique<btBvhTriangleMeshShape>(terrain.meshes.back().get(), true);
+    }
+
+    std::unique_ptr<btHeightfieldTerrainShape> buildHeightfield(Terrain& terrain, const Chunk& chunk) {
+        int size = static_cast<int>(chunk.heightfield.resolution()) + 1;
+
+        terrain.heights.push_back(chunk.heightfield.heights());
+        const std::vector<float>& heights = terrain.heights.back();
+
+        float min = *std::min_element(heights.begin(), heights.end());
+        float max = *std::max_element(heights.begin(), heights.end());
+
+        return std::make_unique<btHeightfieldTerrainShape>(size, size, heights.data(), min, max, 1, false);
+    }
+
+    void addBvhChunk(Terrain& terrain, const Chunk& chunk) {
+        std::unique_ptr<btBvhTriangleMeshShape> shape = buildBvh(terrain, chunk);
+        shape->setLocalScaling(btVector3(WORLD_SCALE, WORLD_SCALE, WORLD_SCALE));
+
+        terrain.add(*shape, btVector3(chunk.x, 0, chunk.y) * WORLD_SCALE);
+        terrain.shapes.push_back(std::move(shape));
+    }
+
+    void addHeightfieldChunk(Terrain& terrain, const Chunk& chunk) {
+        auto resolution = static_cast<float>(chunk.heightfield.resolution());
+
+        std::unique_ptr<btHeightfieldTerrainShape> shape = buildHeightfield(terrain, chunk);
+        shape->setLocalScaling(btVector3(WORLD_SCALE / resolution, WORLD_SCALE, WORLD_SCALE / resolution));
+
+        // Same placement as HeightfieldShape::centre.
+        const std::vector<float>& heights = terrain.heights.back();
+        float centre = (*std::min_element(heights.begin(), heights.end()) + *std::max_element(heights.begin(), heights.end())) / 2;
+
+        terrain.add(*shape, btVector3(chunk.x + 0.5f, centre, chunk.y + 0.5f) * WORLD_SCALE);
+        terrain.shapes.push_back(std::move(shape));
+    }
+
+    // The car from Application, as far as collision goes.
+    std::unique_ptr<btCompoundShape> createCarShape(std::vector<std::unique_ptr<btCollisionShape>>& children) {
+        auto car = std::make_unique<btCompoundShape>();
+
+        children.emplace_back(new btBoxShape({1.f, 0.5f, 2.f}));
+        car->addChildShape(btTransform::getIdentity(), children.back().get());
+
+        btQuaternion wheelRotation({0, 0, 1}, glm::half_pi<float>());
+        for (float z : {-1.5f, 1.5f}) {
+            children.emplace_back(new btCapsuleShape(0.5f, 1.f));
+            car->addChildShape(btTransform(wheelRotation, {0.f, -0.5f, z}), children.back().get());
+        }
+
+        return car;
+    }
+
+    // Terrain height under a world position, as ChunkLoader::heightAt reads it.
+    float groundHeight(const std::vector<Chunk>& chunks, int radius, float x, float z) {
+        float chunkX = std::floor(x / WORLD_SCALE);
+        float chunkY = std::floor(z / WORLD_SCALE);
+
+        size_t index = (static_cast<int>(chunkX) + radius) * (2 * radius + 1) + (static_cast<int>(chunkY) + radius);
+        return chunks[index].heightfield.sample(x / WORLD_SCALE - chunkX, z / WORLD_SCALE - chunkY) * WORLD_SCALE;
+    }
+
+    double microseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    template <typename Fn>
+    double timePerChunk(const std::vector<Chunk>& chunks, int repeats, Fn&& build) {
+        auto start = Clock::now();
+        for (int i = 0; i < repeats; i++) {
+            Terrain terrain;
+            for (const Chunk& chunk : chunks) {
+                build(terrain, chunk);
+            }
+        }
+        return microseconds(Clock::now() - start) / static_cast<double>(repeats * chunks.size());
+    }
+
+    struct ContactResult {
+        double stepMicroseconds;
+        double contactsPerStep;
+        // Cars still resting on the surface at the end, rather than having tunnelled through it.
+        int grounded;
+    };
+
+    ContactResult simulateCars(const std::vector<Chunk>& chunks, int radius, int cars, int steps,
+                               const std::function<void(Terrain&, const Chunk&)>& addChunk) {
+        Terrain terrain;
+        for (const Chunk& chunk : chunks) {
+            addChunk(terrain, chunk);
+        }
+
+        std::vector<std::unique_ptr<btCollisionShape>> carChildren;
+        std::unique_ptr<btCompoundShape> carShape = createCarShape(carChildren);
+
+        // Same drop points and launch velocities for both paths, away from the edges so no car drives off the world.
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> position(static_cast<float>(1 - radius), static_cast<float>(radius));
+        std::uniform_real_distribution<float> direction(0, glm::two_pi<float>());
+
+        std::vector<btRigidBody*> carBodies;
+        for (int i = 0; i < cars; i++) {
+            float x = position(random) * WORLD_SCALE;
+            float z = position(random) * WORLD_SCALE;
+            float angle = direction(random);
+
+            btRigidBody& body = terrain.add(*carShape, {x, groundHeight(chunks, radius, x, z) + 2, z}, 1);
+            body.setLinearVelocity(btVector3(std::sin(angle), 0, std::cos(angle)) * 20);
+            body.setActivationState(DISABLE_DEACTIVATION);
+            carBodies.push_back(&body);
+        }
+
+        // Let the cars settle before measuring.
+        for (int i = 0; i < 60; i++) {
+            terrain.world->stepSimulation(TIME_STEP, 1, TIME_STEP);
+        }
+
+        size_t contacts = 0;
+        Clock::duration elapsed{};
+
+        for (int i = 0; i < steps; i++) {
+            auto start = Clock::now();
+            terrain.world->stepSimulation(TIME_STEP, 1, TIME_STEP);
+            elapsed += Clock::now() - start;
+
+            for (int m = 0; m < terrain.dispatcher->getNumManifolds(); m++) {
+                contacts += terrain.dispatcher->getManifoldByIndexInternal(m)->getNumContacts();
+            }
+        }
+
+        int grounded = 0;
+        for (btRigidBody* body : carBodies) {
+            const btVector3& position = body->getWorldTransform().getOrigin();
+            if (std::abs(position.y() - groundHeight(chunks, radius, position.x(), position.z())) < 5) grounded++;
+        }
+
+        return {
+            microseconds(elapsed) / steps,
+            static_cast<double>(contacts) / steps,
+            grounded
+        };
+    }
+
+    // Largest disagreement between the two shapes over a grid of vertical rays.
+    float compareSurfaces(const std::vector<Chunk>& chunks) {
+        Terrain bvh;
+        Terrain heightfield;
+        for (const Chunk& chunk : chunks) {
+            addBvhChunk(bvh, chunk);
+            addHeightfieldChunk(heightfield, chunk);
+        }
+
+        float worst = 0;
+        for (const Chunk& chunk : chunks) {
+            for (int i = 0; i < 16; i++) {
+                for (int j = 0; j < 16; j++) {
+                    float x = (static_cast<float>(chunk.x) + (static_cast<float>(i) + 0.37f) / 16) * WORLD_SCALE;
+                    float z = (static_cast<float>(chunk.y) + (static_cast<float>(j) + 0.61f) / 16) * WORLD_SCALE;
+
+                    btVector3 from(x, WORLD_SCALE, z);
+                    btVector3 to(x, -WORLD_SCALE, z);
+
+                    btCollisionWorld::ClosestRayResultCallback a(from, to);
+                    btCollisionWorld::ClosestRayResultCallback b(from, to);
+                    bvh.world->rayTest(from, to, a);
+                    heightfield.world->rayTest(from, to, b);
+
+                    if (!a.hasHit() || !b.hasHit()) return std::numeric_limits<float>::infinity();
+                    worst = std::max(worst, std::abs(a.m_hitPointWorld.y() - b.m_hitPointWorld.y()));
+                }
+            }
+        }
+
+        return worst;
+    }
+}
+
+int main(int argc, char** argv) {
+    using namespace infd::generator;
+
+    unsigned int seed = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 0;
+    int radius = argc > 2 ? std::atoi(argv[2]) : 3;
+    int cars = argc > 3 ? std::atoi(argv[3]) : 32;
+    int steps = argc > 4 ? std::atoi(argv[4]) : 600;
+
+    PerlinNoise noise(seed);
+
+    std::vector<Chunk> chunks;
+    for (int x = -radius; x <= radius; x++) {
+        for (int y = -radius; y <= radius; y++) {
+            chunks.push_back({x, y, Heightfield(x, y, TERRAIN_RESOLUTION, noise)});
+        }
+    }
+
+    std::printf("seed %u, %zu chunks, %u x %u cells each\n\n", seed, chunks.size(), TERRAIN_RESOLUTION, TERRAIN_RESOLUTION);
+
+    float difference = compareSurfaces(chunks);
+    bool agree = difference <= SURFACE_TOLERANCE;
+    std::printf("surface agreement: max ray hit difference %.4f world units %s\n\n", difference,
+                agree ? "(within tolerance)" : "(MISMATCH)");
+
+    constexpr int repeats = 20;
+    double bvhBuild = timePerChunk(chunks, repeats, [](Terrain& terrain, const Chunk& chunk) {
+        terrain.shapes.push_back(buildBvh(terrain, chunk));
+    });
+    double heightfieldBuild = timePerChunk(chunks, repeats, [](Terrain& terrain, const Chunk& chunk) {
+        terrain.shapes.push_back(buildHeightfield(terrain, chunk));
+    });
+
+    std::printf("%-12s %14s %14s %16s %10s\n", "path", "build us/chunk", "step us", "contacts/step", "grounded");
+
+    ContactResult bvh = simulateCars(chunks, radius, cars, steps, addBvhChunk);
+    std::printf("%-12s %14.2f %14.2f %16.2f %7d/%-2d\n", "bvh", bvhBuild, bvh.stepMicroseconds, bvh.contactsPerStep, bvh.grounded, cars);
+
+    ContactResult heightfield = simulateCars(chunks, radius, cars, steps, addHeightfieldChunk);
+    std::printf("%-12s %14.2f %14.2f %16.2f %7d/%-2d\n", "heightfield", heightfieldBuild, heightfield.stepMicroseconds, heightfield.contactsPerStep, heightfield.grounded, cars);
+
+    return agree ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+// Times PerlinNoise's 2D and fractal sampling against the 3D sampling the terrain used to go through, per kernel, and
+// pins their output down: every kernel must match the scalar path bit for bit, in 3D batches and grids as well as 2D
+// ones, the 2D noise must equal the 3D noise on the same layer, and a checksum of the terrain and highway noise must match the one recorded below. Exits
+// non-zero if any doesn't. A deliberate change to the noise has to update the checksums.
+//
+// usage: noise_bench [samples]
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// project - generator
+#include <infd/generator/ChunkGenerator.hpp>
+#include <infd/generator/PerlinNoise.hpp>
+
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using infd::generator::PerlinNoise;
+
+    const unsigned int SEEDS[] = {0, 1, 42};
+    // FNV-1a of the terrain then highway noise over points() at the default sample count, per seed.
+    const std::uint64_t CHECKSUMS[] = {0xbb989512e87a1d6dull, 0x025f7c8669a6e5a1ull, 0x7c597ffd6c1cc4f9ull};
+
+    const PerlinNoise::Fractal DETAILED = {5, 0.75f, 2.f, 0.5f, 3};
+
+    // Slices the 3D batches are checked on, between layers as well as on one.
+    const float SLICES[] = {static_cast<float>(infd::generator::PERLIN_LAYER), 0.37f, -1.5f};
+    // An odd width, so every kernel leaves a remainder for the scalar path.
+    const size_t GRID_WIDTH = 37;
+    const size_t GRID_HEIGHT = 23;
+    const float GRID_X = -3.7f;
+    const float GRID_Y = -2.1f;
+    const float GRID_STEP_X = 0.173f;
+    const float GRID_STEP_Y = 0.25f;
+
+    // Covers negative coordinates and lattice points, where the rounding is easiest to get wrong.
+    void points(size_t n, std::vector<float>& xs, std::vector<float>& ys) {
+        xs.resize(n);
+        ys.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            xs[i] = static_cast<float>(static_cast<int>(i % 97) - 48) * 0.173f;
+            ys[i] = static_cast<float>(static_cast<int>(i / 97 % 89) - 44) * 0.25f;
+        }
+    }
+
+    std::uint64_t fnv(const std::vector<float>& values, std::uint64_t hash) {
+        for (float value : values) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (int byte = 0; byte < 4; byte++) {
+                hash = (hash ^ ((bits >> (8 * byte)) & 0xffu)) * 0x100000001b3ull;
+            }
+        }
+        return hash;
+    }
+
+    // Nanoseconds per sample.
+    double time(size_t n, int repeats, const std::function<void()>& sample) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < repeats; i++) {
+            sample();
+        }
+        std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        return elapsed.count() / (repeats * static_cast<double>(n));
+    }
+
+    const char* name(PerlinNoise::Kernel kernel) {
+        switch (kernel) {
+            case PerlinNoise::Kernel::Scalar: return "scalar";
+            case PerlinNoise::Kernel::Sse2: return "sse2";
+            case PerlinNoise::Kernel::Avx2: return "avx2";
+        }
+        return "?";
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 16;
+
+    std::vector<float> xs;
+    std::vector<float> ys;
+    points(count, xs, ys);
+
+    PerlinNoise::Kernel best = PerlinNoise::kernel();
+    bool valid = true;
+
+    for (size_t s = 0; s < std::size(SEEDS); s++) {
+        PerlinNoise noise(SEEDS[s]);
+
+        // The layer is what the 3D noise's z used to be, so these must agree.
+        int slices = 0;
+        for (size_t i = 0; i < count; i++) {
+            float z = static_cast<float>(infd::generator::PERLIN_LAYER);
+            if (noise.sample<float>(xs[i], ys[i], infd::generator::PERLIN_LAYER) != noise.sample<float>(xs[i], ys[i], z)) slices++;
+        }
+
+        std::vector<float> terrain(count);
+        std::vector<float> highway(count);
+        std::vector<float> detailed(count);
+        for (size_t i = 0; i < count; i++) {
+            terrain[i] = noise.sample<float>(xs[i], ys[i], infd::generator::TERRAIN_NOISE);
+            highway[i] = noise.sample<float>(xs[i], ys[i], infd::generator::HIGHWAY_NOISE);
+            detailed[i] = noise.sample<float>(xs[i], ys[i], DETAILED);
+        }
+
+        std::vector<std::vector<float>> slices3d;
+        std::vector<std::vector<float>> grids;
+        for (float z : SLICES) {
+            std::vector<float>& slice = slices3d.emplace_back(count);
+            for (size_t i = 0; i < count; i++) slice[i] = noise.sample<float>(xs[i], ys[i], z);
+
+            std::vector<float>& grid = grids.emplace_back(GRID_WIDTH * GRID_HEIGHT);
+            for (size_t j = 0; j < GRID_HEIGHT; j++) {
+                for (size_t i = 0; i < GRID_WIDTH; i++) {
+                    grid[j * GRID_WIDTH + i] = noise.sample<float>(static_cast<float>(i) * GRID_STEP_X + GRID_X,
+                                                                   static_cast<float>(j) * GRID_STEP_Y + GRID_Y, z);
+                }
+            }
+        }
+
+        std::uint64_t checksum = fnv(highway, fnv(terrain, 0xcbf29ce484222325ull));
+        bool pinned = argc > 1 || checksum == CHECKSUMS[s];
+
+        int kernels = 0;
+        for (PerlinNoise::Kernel kernel : {PerlinNoise::Kernel::Scalar, PerlinNoise::Kernel::Sse2, PerlinNoise::Kernel::Avx2}) {
+            if (!PerlinNoise::supported(kernel)) continue;
+            PerlinNoise::kernel(kernel);
+
+            std::vector<float> batch(count);
+            for (const auto& [fractal, expected] : {std::pair(&infd::generator::TERRAIN_NOISE, &terrain),
+                                                     std::pair(&infd::generator::HIGHWAY_NOISE, &highway),
+                                                     std::pair(&DETAILED, &detailed)}) {
+                noise.sampleN(xs.data(), ys.data(), count, *fractal, batch.data());
+                if (std::memcmp(batch.data(), expected->data(), count * sizeof(float)) != 0) kernels++;
+            }
+
+            std::vector<float> grid(GRID_WIDTH * GRID_HEIGHT);
+            for (size_t slice = 0; slice < std::size(SLICES); slice++) {
+                noise.sampleN(xs.data(), ys.data(), SLICES[slice], count, batch.data());
+                if (std::memcmp(batch.data(), slices3d[slice].data(), count * sizeof(float)) != 0) kernels++;
+
+                noise.sampleGrid(GRID_X, GRID_Y, GRID_STEP_X, GRID_STEP_Y, GRID_WIDTH, GRID_HEIGHT, SLICES[slice], grid.data());
+                if (std::memcmp(grid.data(), grids[slice].data(), grid.size() * sizeof(float)) != 0) kernels++;
+            }
+        }
+        PerlinNoise::kernel(best);
+
+        std::printf("seed %-4u checksum %016llx %s, 2D/3D mismatches %d, kernel mismatches %d\n", SEEDS[s],
+                    static_cast<unsigned long long>(checksum), argc > 1 ? "(unpinned)" : pinned ? "(pinned)" : "(MISMATCH)",
+                    slices, kernels);
+        if (!pinned) std::printf("    expected %016llx\n", static_cast<unsigned long long>(CHECKSUMS[s]));
+
+        valid = valid && pinned && slices == 0 && kernels == 0;
+    }
+
+    std::printf("\n%zu samples, ns per sample\n", count);
+    std::printf("%-8s %10s %10s %10s %10s\n", "kernel", "3D", "2D", "speedup", "5 octaves");
+
+    PerlinNoise noise(SEEDS[0]);
+    std::vector<float> out(count);
+    float z = static_cast<float>(infd::generator::PERLIN_LAYER);
+    constexpr int repeats = 20;
+
+    for (PerlinNoise::Kernel kernel : {PerlinNoise::Kernel::Scalar, PerlinNoise::Kernel::Sse2, PerlinNoise::Kernel::Avx2}) {
+        if (!PerlinNoise::supported(kernel)) continue;
+        PerlinNoise::kernel(kernel);
+
+        double slice = time(count, repeats, [&] { noise.sampleN(xs.data(), ys.data(), z, count, out.data()); });
+        double flat = time(count, repeats, [&] { noise.sampleN(xs.data(), ys.data(), count, infd::generator::TERRAIN_NOISE, out.data()); });
+        double fractal = time(count, repeats, [&] { noise.sampleN(xs.data(), ys.data(), count, DETAILED, out.data()); });
+
+        std::printf("%-8s %10.2f %10.2f %9.2fx %10.2f\n", name(kernel), slice, flat, slice / flat, fractal);
+    }
+    PerlinNoise::kernel(best);
+
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+// Times meshbuilding::Polygon's triangulation against plain poly2tri, over the kinds of polygon the mesh builders
+// feed it, and checks every triangulation covers the same area as the CDT's with the same winding. Exits non-zero if
+// any doesn't.
+//
+// usage: triangulate_bench [seed] [polygons per shape]
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+// glm
+#include <glm/gtc/constants.hpp>
+
+// project - generator
+#include <infd/generator/meshbuilding/Polygon.hpp>
+
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using infd::generator::meshbuilding::Polygon;
+
+    const double AREA_TOLERANCE = 1e-9;
+
+    using Outline = std::vector<glm::vec2>;
+
+    struct Shape {
+        std::string name;
+        std::function<Outline(std::mt19937&)> generate;
+    };
+
+    // Points around a circle of radius 1, at the given angles and radius scales, wound either way.
+    Outline around(std::mt19937& random, std::vector<float> angles, const std::function<float()>& radius) {
+        std::sort(angles.begin(), angles.end());
+
+        Outline outline;
+        for (float angle : angles) {
+            float r = radius();
+            outline.emplace_back(std::cos(angle) * r, std::sin(angle) * r);
+        }
+
+        if (std::bernoulli_distribution(0.5)(random)) std::reverse(outline.begin(), outline.end());
+        return outline;
+    }
+
+    // Like the intersections and skyscraper parts, an n-gon with its corners nudged but still convex.
+    Outline convex(std::mt19937& random, unsigned int sides) {
+        std::uniform_real_distribution<float> rotation(0, glm::two_pi<float>());
+        std::uniform_real_distribution<float> nudge(-0.2f, 0.2f);
+
+        float offset = rotation(random);
+        std::vector<float> angles;
+        for (unsigned int i = 0; i < sides; i++) {
+            angles.push_back(offset + (static_cast<float>(i) + nudge(random)) * glm::two_pi<float>() / static_cast<float>(sides));
+        }
+        return around(random, angles, [] { return 1.f; });
+    }
+
+    // Star shaped, so simple but mostly concave, like the unioned building roofs.
+    Outline concave(std::mt19937& random, unsigned int points) {
+        std::uniform_real_distribution<float> angle(0, glm::two_pi<float>());
+        std::uniform_real_distribution<float> radius(0.3f, 1.f);
+
+        std::vector<float> angles;
+        for (unsigned int i = 0; i < points; i++) {
+            angles.push_back(angle(random));
+        }
+        return around(random, angles, [&] { return radius(random); });
+    }
+
+    Polygon toPolygon(const Outline& outline) {
+        Polygon polygon;
+        for (glm::vec2 point : outline) {
+            polygon.addPoint(point);
+        }
+        return polygon;
+    }
+
+    double signedArea(const Polygon& polygon, const Polygon::Face& face) {
+        const p2t::Point& a = polygon.points[face[0]];
+        const p2t::Point& b = polygon.points[face[1]];
+        const p2t::Point& c = polygon.points[face[2]];
+        return ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) / 2;
+    }
+
+    // Every face must wind the way the CDT's do and together cover what the CDT's cover.
+    bool matchesCdt(Polygon& polygon) {
+        std::pmr::vector<Polygon::Face> faces = polygon.triangulate();
+        const std::pmr::vector<Polygon::Face>& reference = polygon.triangulateCdt();
+
+        double expected = 0;
+        for (const Polygon::Face& face : reference) {
+            expected += signedArea(polygon, face);
+        }
+
+        double covered = 0;
+        for (const Polygon::Face& face : faces) {
+            double area = signedArea(polygon, face);
+            if (area * expected <= 0) return false;
+            covered += area;
+        }
+
+        return faces.size() == reference.size() && std::abs(covered - expected) <= AREA_TOLERANCE * std::abs(expected);
+    }
+
+    // Microseconds per polygon.
+    double time(std::vector<Polygon>& polygons, int repeats, const std::function<void(Polygon&)>& triangulate) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < repeats; i++) {
+            for (Polygon& polygon : polygons) {
+                triangulate(polygon);
+            }
+        }
+        std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+        return elapsed.count() / (repeats * static_cast<double>(polygons.size()));
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned int seed = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 0;
+    int count = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    std::vector<Shape> shapes = {
+        {"quad", [](std::mt19937& random) { return convex(random, 4); }},
+        {"octagon", [](std::mt19937& random) { return convex(random, 8); }},
+        {"convex-16", [](std::mt19937& random) { return convex(random, 16); }},
+        {"concave-8", [](std::mt19937& random) { return concave(random, 8); }},
+        {"concave-24", [](std::mt19937& random) { return concave(random, 24); }},
+        {"concave-64", [](std::mt19937& random) { return concave(random, 64); }},
+    };
+
+    std::mt19937 random(seed);
+    bool valid = true;
+
+    std::printf("seed %u, %d polygons per shape\n\n", seed, count);
+    std::printf("%-12s %10s %10s %10s %12s %12s %8s %8s\n", "shape", "fan", "ears", "cdt", "polygon us", "poly2tri us", "speedup", "valid");
+
+    for (const Shape& shape : shapes) {
+        std::vector<Polygon> polygons;
+        for (int i = 0; i < count; i++) {
+            polygons.push_back(toPolygon(shape.generate(random)));
+        }
+
+        int methods[4] = {};
+        int mismatches = 0;
+        for (Polygon& polygon : polygons) {
+            if (!matchesCdt(polygon)) mismatches++;
+            polygon.triangulate();
+            methods[static_cast<int>(polygon.method())]++;
+        }
+        valid = valid && mismatches == 0;
+
+        constexpr int repeats = 10;
+        double fast = time(polygons, repeats, [](Polygon& polygon) { polygon.triangulate(); });
+        double cdt = time(polygons, repeats, [](Polygon& polygon) { polygon.triangulateCdt(); });
+
+        std::printf("%-12s %10d %10d %10d %12.3f %12.3f %7.1fx %8s\n", shape.name.c_str(),
+                    methods[static_cast<int>(Polygon::Method::Fan)],
+                    methods[static_cast<int>(Polygon::Method::EarClipping)],
+                    methods[static_cast<int>(Polygon::Method::Cdt)],
+                    fast, cdt, cdt / fast, mismatches == 0 ? "yes" : std::to_string(mismatches).c_str());
+    }
+
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,400 @@
+// Generates a square region of chunks for each of a list of seeds without any GL, timing every stage separately.
+// Each chunk is reported with its graph and mesh sizes and a hash of everything generated for it, so an optimisation
+// can be checked against the output of a baseline build as well as timed against it, along with how many times
+// generating it went to the heap and whether anything was left out of it to keep within its generation budget.
+//
+// usage: worldgen_bench [--size N] [--seeds S,S,...] [--repeat R] [--format json|csv] [--output FILE]
+//
+// Chunks (0, 0) to (N-1, N-1) are generated, R times each, keeping the fastest time of every stage. Results go to
+// stdout unless an output file is given, with totals per stage and percentiles of whole chunk times on stderr. Exits
+// non-zero if a chunk hashes differently between runs or has more building triangles than its budget allows.
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// bullet
+#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+
+// project - generator
+#include <infd/generator/ChunkData.hpp>
+#include <infd/generator/PerlinNoise.hpp>
+#include <infd/generator/StageTimes.hpp>
+#include <infd/generator/meshbuilding/PerlinMesh.hpp>
+
+
+namespace {
+    // Every operator new in the program, on any thread.
+    std::atomic<size_t> heapAllocations = 0;
+}
+
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+    using namespace infd::generator;
+    using Clock = StageTimes::Clock;
+    using Duration = StageTimes::Duration;
+
+    // Every timed stage, in the order they run. The last two aren't part of ChunkData, so they're timed here.
+    struct Stage {
+        const char* name;
+        Duration StageTimes::* field;
+    };
+
+    const Stage GENERATOR_STAGES[] = {
+        {"heightfield", &StageTimes::heightfield},
+        {"populateRoots", &StageTimes::populateRoots},
+        {"generateNetwork", &StageTimes::generateNetwork},
+        {"trimNetwork", &StageTimes::trimNetwork},
+        {"sortEdges", &StageTimes::sortEdges},
+        {"findCycles", &StageTimes::findCycles},
+        {"roadMesh", &StageTimes::roadMesh},
+        {"buildingMeshes", &StageTimes::buildingMeshes},
+    };
+    // All the CPU still does for terrain rendering, as the mesh is a grid shared by every chunk.
+    const char* TERRAIN_SKIRT = "terrainSkirt";
+    const char* COLLISION = "collision";
+
+    struct Options {
+        int size = 4;
+        std::vector<unsigned int> seeds{0};
+        int repeat = 1;
+        bool csv = false;
+        const char* output = nullptr;
+    };
+
+    struct ChunkResult {
+        unsigned int seed;
+        int x;
+        int y;
+
+        ChunkResult(unsigned int seed, int x, int y) : seed(seed), x(x), y(y) {}
+
+        StageTimes times;
+        Duration terrainSkirt{};
+        Duration collision{};
+
+        size_t nodes = 0;
+        size_t edges = 0;
+        size_t cycles = 0;
+        size_t buildings = 0;
+        bool overBudget = false;
+
+        size_t terrainTriangles = 0;
+        size_t roadTriangles = 0;
+        size_t buildingTriangles = 0;
+        size_t buildingTriangleBudget = 0;
+        size_t collisionTriangles = 0;
+
+        // Heap allocations made constructing the ChunkData.
+        size_t allocations = 0;
+
+        std::uint64_t hash = 0;
+    };
+
+    // 64 bit FNV-1a, which is stable across platforms and builds as long as the bytes fed to it are.
+    class Hash {
+        std::uint64_t _value = 14695981039346656037ull;
+
+    public:
+        void add(const void* data, size_t size) {
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                _value ^= bytes[i];
+                _value *= 1099511628211ull;
+            }
+        }
+
+        template <typename T>
+        void add(const std::vector<T>& values) {
+            add(values.data(), values.size() * sizeof(T));
+        }
+
+        void add(const infd::GLMeshBuilder& mesh) {
+            add(mesh.vertices);
+            add(mesh.indices);
+        }
+
+        [[nodiscard]] std::uint64_t value() const {
+            return _value;
+        }
+    };
+
+    double microseconds(Duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    // Builds the collision BVH over a mesh's triangles, as attaching the chunk would.
+    size_t buildCollision(btTriangleMesh& triangles) {
+        if (triangles.getNumTriangles() == 0) return 0;
+
+        btBvhTriangleMeshShape shape(&triangles, true);
+        return static_cast<size_t>(triangles.getNumTriangles());
+    }
+
+    ChunkResult generate(int x, int y, unsigned int seed, PerlinNoise& noise) {
+        std::atomic<bool> cancelled = false;
+        ChunkResult result{seed, x, y};
+
+        size_t allocations = heapAllocations.load();
+        ChunkData data(x, y, seed, noise, cancelled, &result.times);
+        result.allocations = heapAllocations.load() - allocations;
+        const ChunkGenerator& generator = data.generator;
+
+        Clock::time_point start = Clock::now();
+        float skirtDepth = meshbuilding::terrainSkirtDepth(generator.heightfield);
+        result.terrainSkirt = Clock::now() - start;
+
+        start = Clock::now();
+        result.collisionTriangles += buildCollision(*data.roads.tri_mesh);
+        for (ChunkData::Building& building : data.buildings) {
+            result.collisionTriangles += buildCollision(*building.data.tri_mesh);
+        }
+        result.collision = Clock::now() - start;
+
+        result.nodes = generator.graph.size();
+        result.edges = generator.graph.edgeCount() / 2;
+        result.cycles = generator.cycles.size();
+        result.buildings = data.buildings.size();
+        result.overBudget = generator.overBudget;
+
+        result.terrainTriangles = meshbuilding::generateTerrainGrid(generator.heightfield.resolution()).indices.size() / 3;
+        result.roadTriangles = data.roads.mesh.indices.size() / 3;
+        for (const ChunkData::Building& building : data.buildings) {
+            result.buildingTriangles += building.data.mesh.indices.size() / 3;
+        }
+        result.buildingTriangleBudget = generator.budget.buildingTriangles;
+
+        Hash hash;
+        hash.add(generator.heightfield.samples());
+        hash.add(&skirtDepth, sizeof(skirtDepth));
+        hash.add(generator.graph.x);
+        hash.add(generator.graph.y);
+        hash.add(generator.graph.edgeTo);
+        for (const Clipper2Lib::PathD& cycle : generator.cycles) hash.add(cycle);
+        hash.add(data.roads.mesh);
+        for (const ChunkData::Building& building : data.buildings) {
+            hash.add(building.data.mesh);
+            hash.add(&building.colour, sizeof(building.colour));
+        }
+        result.hash = hash.value();
+
+        return result;
+    }
+
+    // Keeps the faster time of every stage, for repeated runs of the same chunk.
+    void keepFastest(ChunkResult& best, const ChunkResult& run) {
+        for (const Stage& stage : GENERATOR_STAGES) {
+            best.times.*stage.field = std::min(best.times.*stage.field, run.times.*stage.field);
+        }
+        best.terrainSkirt = std::min(best.terrainSkirt, run.terrainSkirt);
+        best.collision = std::min(best.collision, run.collision);
+        best.allocations = std::min(best.allocations, run.allocations);
+    }
+
+    std::vector<double> stageTimes(const ChunkResult& result) {
+        std::vector<double> times;
+        for (const Stage& stage : GENERATOR_STAGES) times.push_back(microseconds(result.times.*stage.field));
+        times.push_back(microseconds(result.terrainSkirt));
+        times.push_back(microseconds(result.collision));
+        return times;
+    }
+
+    std::vector<const char*> stageNames() {
+        std::vector<const char*> names;
+        for (const Stage& stage : GENERATOR_STAGES) names.push_back(stage.name);
+        names.push_back(TERRAIN_SKIRT);
+        names.push_back(COLLISION);
+        return names;
+    }
+
+    void writeCsv(std::FILE* out, const std::vector<ChunkResult>& results) {
+        std::fprintf(out, "seed,x,y");
+        for (const char* name : stageNames()) std::fprintf(out, ",%s_us", name);
+        std::fprintf(out, ",nodes,edges,cycles,buildings,terrain_triangles,road_triangles,building_triangles,collision_triangles,over_budget,allocations,hash\n");
+
+        for (const ChunkResult& result : results) {
+            std::fprintf(out, "%u,%d,%d", result.seed, result.x, result.y);
+            for (double time : stageTimes(result)) std::fprintf(out, ",%.2f", time);
+            std::fprintf(out, ",%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%d,%zu,%016llx\n",
+                         result.nodes, result.edges, result.cycles, result.buildings,
+                         result.terrainTriangles, result.roadTriangles, result.buildingTriangles, result.collisionTriangles,
+                         result.overBudget, result.allocations, static_cast<unsigned long long>(result.hash));
+        }
+    }
+
+    void writeJson(std::FILE* out, const Options& options, const std::vector<ChunkResult>& results) {
+        std::vector<const char*> names = stageNames();
+
+        std::fprintf(out, "{\n  \"size\": %d,\n  \"repeat\": %d,\n  \"chunks\": [", options.size, options.repeat);
+        for (size_t i = 0; i < results.size(); i++) {
+            const ChunkResult& result = results[i];
+            std::vector<double> times = stageTimes(result);
+
+            std::fprintf(out, "%s\n    {\"seed\": %u, \"x\": %d, \"y\": %d, \"times_us\": {", i == 0 ? "" : ",", result.seed, result.x, result.y);
+            for (size_t stage = 0; stage < names.size(); stage++) {
+                std::fprintf(out, "%s\"%s\": %.2f", stage == 0 ? "" : ", ", names[stage], times[stage]);
+            }
+            std::fprintf(out, "}, \"nodes\": %zu, \"edges\": %zu, \"cycles\": %zu, \"buildings\": %zu, ",
+                         result.nodes, result.edges, result.cycles, result.buildings);
+            std::fprintf(out, "\"triangles\": {\"terrain\": %zu, \"roads\": %zu, \"buildings\": %zu, \"collision\": %zu}, ",
+                         result.terrainTriangles, result.roadTriangles, result.buildingTriangles, result.collisionTriangles);
+            std::fprintf(out, "\"over_budget\": %s, \"allocations\": %zu, \"hash\": \"%016llx\"}",
+                         result.overBudget ? "true" : "false", result.allocations,
+                         static_cast<unsigned long long>(result.hash));
+        }
+        std::fprintf(out, "\n  ]\n}\n");
+    }
+
+    void writeSummary(const std::vector<ChunkResult>& results) {
+        std::vector<const char*> names = stageNames();
+        std::vector<double> totals(names.size(), 0);
+        for (const ChunkResult& result : results) {
+            std::vector<double> times = stageTimes(result);
+            for (size_t stage = 0; stage < names.size(); stage++) totals[stage] += times[stage];
+        }
+
+        double total = 0;
+        for (double time : totals) total += time;
+
+        size_t allocations = 0;
+        size_t overBudget = 0;
+        std::vector<double> chunkTimes;
+        for (const ChunkResult& result : results) {
+            allocations += result.allocations;
+            overBudget += result.overBudget;
+            std::vector<double> times = stageTimes(result);
+            double chunkTime = 0;
+            for (double time : times) chunkTime += time;
+            chunkTimes.push_back(chunkTime);
+        }
+        std::sort(chunkTimes.begin(), chunkTimes.end());
+        auto percentile = [&](double p) {
+            return chunkTimes.empty() ? 0 : chunkTimes[std::min(chunkTimes.size() - 1, static_cast<size_t>(p * chunkTimes.size()))];
+        };
+
+        std::fprintf(stderr, "%zu chunks, %.1f ms in total, %zu heap allocations a chunk\n", results.size(), total / 1000,
+                     results.empty() ? 0 : allocations / results.size());
+        std::fprintf(stderr, "  chunk times p50 %.2f ms, p99 %.2f ms, max %.2f ms, %zu chunks over budget\n",
+                     percentile(0.5) / 1000, percentile(0.99) / 1000, percentile(1) / 1000, overBudget);
+        for (size_t stage = 0; stage < names.size(); stage++) {
+            std::fprintf(stderr, "  %-16s %10.1f ms %6.1f%%\n", names[stage], totals[stage] / 1000, 100 * totals[stage] / total);
+        }
+    }
+
+    // Comma separated, or empty if anything in the list isn't a number.
+    std::vector<unsigned int> parseSeeds(const char* list) {
+        std::vector<unsigned int> seeds;
+        const char* value = list;
+
+        while (true) {
+            char* end;
+            unsigned long seed = std::strtoul(value, &end, 10);
+            if (end == value) return {};
+
+            seeds.push_back(static_cast<unsigned int>(seed));
+            if (*end == '\0') return seeds;
+            if (*end != ',') return {};
+            value = end + 1;
+        }
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--size") == 0 && hasValue) {
+                options.size = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--seeds") == 0 && hasValue) {
+                options.seeds = parseSeeds(argv[++i]);
+            } else if (std::strcmp(argv[i], "--repeat") == 0 && hasValue) {
+                options.repeat = std::max(std::atoi(argv[++i]), 1);
+            } else if (std::strcmp(argv[i], "--format") == 0 && hasValue) {
+                const char* format = argv[++i];
+                if (std::strcmp(format, "csv") != 0 && std::strcmp(format, "json") != 0) return false;
+                options.csv = std::strcmp(format, "csv") == 0;
+            } else if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+                options.output = argv[++i];
+            } else {
+                return false;
+            }
+        }
+        return options.size > 0 && !options.seeds.empty();
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--size N] [--seeds S,S,...] [--repeat R] [--format json|csv] [--output FILE]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<ChunkResult> results;
+    bool deterministic = true;
+    bool withinBudget = true;
+
+    for (unsigned int seed : options.seeds) {
+        PerlinNoise noise(seed);
+
+        for (int x = 0; x < options.size; x++) {
+            for (int y = 0; y < options.size; y++) {
+                ChunkResult best = generate(x, y, seed, noise);
+
+                for (int run = 1; run < options.repeat; run++) {
+                    ChunkResult again = generate(x, y, seed, noise);
+                    if (again.hash != best.hash) {
+                        std::fprintf(stderr, "seed %u chunk (%d, %d) hashed differently on run %d\n", seed, x, y, run + 1);
+                        deterministic = false;
+                    }
+                    keepFastest(best, again);
+                }
+
+                if (best.buildingTriangles > best.buildingTriangleBudget ||
+                    best.buildingTriangles > MAX_BUILDING_TRIANGLE_BUDGET) {
+                    std::fprintf(stderr, "seed %u chunk (%d, %d) has %zu building triangles, over its budget of %zu\n",
+                                 seed, x, y, best.buildingTriangles, best.buildingTriangleBudget);
+                    withinBudget = false;
+                }
+
+                results.push_back(best);
+            }
+        }
+    }
+
+    std::FILE* out = options.output ? std::fopen(options.output, "w") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "could not open %s\n", options.output);
+        return 1;
+    }
+
+    if (options.csv) {
+        writeCsv(out, results);
+    } else {
+        writeJson(out, options, results);
+    }
+    if (out != stdout) std::fclose(out);
+
+    writeSummary(results);
+    return deterministic && withinBudget ? 0 : 1;
+}
@@ -80,5 +80,17 @@ namespace infd {
 		 * After build completion, this builder can be destroyed.
 		 */
 		GLMesh build() const;
+
+		/*
+		 * build a GLMesh straight from vertex and index data held elsewhere, e.g. in a memory mapped file,
+		 * without copying it into a builder first.
+		 */
+		static GLMesh build(
+			GLenum mode,
+			const MeshVertex *vertices,
+			std::size_t vertex_count,
+			const unsigned int *indices,
+			std::size_t index_count
+		);
 	};
 }
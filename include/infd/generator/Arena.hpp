@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace infd::generator {
+    /**
+     * Scratch memory for building one chunk. Allocations are bumped off blocks, never freed one at a time, and all
+     * given back at once by reset, which keeps the blocks for the next round.
+     *
+     * Each OpenMP thread of the team building the chunk bumps off blocks of its own, so containers on it can be
+     * grown from inside parallelFor without locking. Threads past the team it was sized for share one locked slot.
+     * Deallocating does nothing, so whatever lives here must be dropped before the next reset.
+     */
+    class Arena final : public std::pmr::memory_resource {
+        struct Slot {
+            std::vector<std::unique_ptr<std::byte[]>> blocks;
+            // Size of each block in blocks.
+            std::vector<size_t> sizes;
+            size_t block = 0;
+            size_t used = 0;
+
+            void* allocate(size_t bytes, size_t alignment);
+            void reset();
+        };
+
+        std::vector<Slot> _slots;
+        Slot _overflow;
+        std::mutex _overflowMutex;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    public:
+        // Smallest block a slot allocates, each further block at least doubles the last.
+        static const size_t BLOCK_SIZE = 64 * 1024;
+
+        /**
+         * Sized for the threads parallelFor would use if called from this thread. Nothing is allocated until needed.
+         */
+        Arena();
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        /**
+         * Gives everything allocated so far back at once. Blocks are kept, merged into one per slot so the next round
+         * bumps off a single block.
+         */
+        void reset();
+    };
+}
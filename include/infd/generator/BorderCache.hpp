@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace infd::generator {
+    /**
+     * Roots of the roads crossing the edge between two neighbouring chunks. Both chunks grow their networks from
+     * these, so the roads meet at the edge.
+     */
+    struct Border {
+        // Which edge of the chunk it's keyed by. The other two edges are the Down and Right edges of a neighbour.
+        enum class Side : std::uint8_t {
+            Down,
+            Right
+        };
+
+        // Where each road crosses, from 0 to 1 along the edge.
+        std::vector<float> positions;
+        // How far each road turns from square to the edge, in radians.
+        std::vector<float> angles;
+        // Mean of the highway factors of the chunks either side, which sets how many roads cross.
+        float highwayFactor = 0;
+    };
+
+    /**
+     * Borders shared by the chunks generated so far, so each is generated once however many chunks use it.
+     *
+     * Entries are held by the chunks that use them, and are dropped once the last of those is. Safe to share between
+     * threads. Two threads may still generate the same border at once, in which case the one stored first wins and
+     * both chunks use it.
+     */
+    class BorderCache {
+        std::unordered_map<std::uint64_t, std::weak_ptr<const Border>> _borders;
+        // Expired entries are swept once the map grows past this.
+        size_t _sweepAt = 64;
+        size_t _hits = 0;
+        size_t _misses = 0;
+
+        mutable std::mutex _mutex;
+
+        static std::uint64_t key(int x, int y, Border::Side side);
+
+        std::shared_ptr<const Border> find(std::uint64_t key);
+        std::shared_ptr<const Border> insert(std::uint64_t key, std::shared_ptr<const Border> border);
+
+    public:
+        /**
+         * The border on the given side of the chunk at (x, y), generated by generate() unless a chunk holds it
+         * already. generate() is called without the lock held.
+         */
+        template <typename Fn>
+        std::shared_ptr<const Border> get(int x, int y, Border::Side side, Fn&& generate);
+
+        /**
+         * Borders currently held by at least one chunk.
+         */
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] size_t hits() const;
+        [[nodiscard]] size_t misses() const;
+    };
+
+    template <typename Fn>
+    std::shared_ptr<const Border> BorderCache::get(int x, int y, Border::Side side, Fn&& generate) {
+        std::uint64_t k = key(x, y, side);
+        if (std::shared_ptr<const Border> border = find(k)) return border;
+
+        return insert(k, std::make_shared<const Border>(generate()));
+    }
+}
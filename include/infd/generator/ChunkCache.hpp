@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include "ChunkFile.hpp"
+
+namespace infd::generator {
+    /**
+     * Directory of serialised chunks, one ChunkFile per chunk at <root>/<seed>/<x>_<y>.chunk, loaded by mapping them
+     * into memory.
+     *
+     * Safe to share between threads. Files are written under a temporary name and renamed into place, so a reader
+     * never sees one half written. Nothing is ever evicted; stale versions are just overwritten as they're found.
+     */
+    class ChunkCache {
+        std::filesystem::path _directory;
+        unsigned int _seed;
+
+    public:
+        ChunkCache(const std::filesystem::path& root, unsigned int seed);
+
+        [[nodiscard]] const std::filesystem::path& directory() const;
+        [[nodiscard]] std::filesystem::path path(int x, int y) const;
+
+        /**
+         * Maps the cached chunk at (x, y). Returns nullptr if there is none, or it's unreadable or from another
+         * version.
+         */
+        [[nodiscard]] std::unique_ptr<ChunkFile> load(int x, int y) const;
+
+        /**
+         * Writes out a serialised chunk. Returns false if it couldn't be written, which is otherwise harmless, since
+         * the chunk can always be generated again.
+         */
+        bool store(int x, int y, const ChunkFile::Buffer& bytes) const;
+    };
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "glm/vec3.hpp"
+#include "ChunkGenerator.hpp"
+#include "PerlinNoise.hpp"
+#include "StageTimes.hpp"
+#include "meshbuilding/MeshData.hpp"
+
+namespace infd::generator {
+    /**
+     * Everything generated for a chunk, entirely on the CPU. Safe to construct off the main thread. It's attached to
+     * the scene through ChunkFile.
+     */
+    class ChunkData {
+    public:
+        struct Building {
+            meshbuilding::MeshData data;
+            glm::vec3 colour;
+        };
+
+        ChunkGenerator generator;
+
+        meshbuilding::MeshData roads;
+        std::vector<Building> buildings;
+
+        /**
+         * Generates the chunk at the given location. Generation stops early between stages once
+         * cancelled is set, in which case the data is incomplete and should be discarded. The time taken by each stage
+         * is added to times, if given. Border roots are shared through borderCache, if given.
+         */
+        ChunkData(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, const std::atomic<bool>& cancelled,
+                  StageTimes* times = nullptr, BorderCache* borderCache = nullptr);
+        ChunkData(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, BorderCache* borderCache, helpers::Deferred);
+
+        /**
+         * Generates the chunk a step at a time, for data constructed as deferred: a step per stage, and per batch
+         * road nodes or buildings. The data must stay where it is until they're done.
+         */
+        helpers::Steps generate(const std::atomic<bool>& cancelled, StageTimes* times = nullptr,
+                                size_t batch = GENERATION_BATCH);
+
+        /**
+         * The stream building i of the chunk draws from, once its colour has been drawn into colour.
+         */
+        static helpers::RandomType buildingRandom(const ChunkGenerator& generator, size_t i, glm::vec3& colour);
+
+    private:
+        /**
+         * Drops the buildings that don't fit the building triangle budget, the last in cycleOrder first. The
+         * estimates the cycles were fitted by can fall short, so this counts the triangles actually meshed.
+         */
+        void fitBuildings();
+    };
+}
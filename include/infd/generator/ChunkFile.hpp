@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
+#include <BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
+#include "infd/GLMesh.hpp"
+#include "infd/util/aligned_containers.hpp"
+#include "ChunkData.hpp"
+#include "Heightfield.hpp"
+
+namespace infd::generator {
+    /**
+     * Binary form of a generated chunk, laid out to be used in place, straight from a memory mapped file.
+     *
+     * It holds the heightfield, and for the roads and each building the render vertices and indices, the collision
+     * triangles and the quantized BVH over them. Render buffers are uploaded directly from the file and collision
+     * reads from it without copying, so opening one costs little more than touching its pages. The terrain is drawn
+     * from the heightfield alone, see TerrainGrids.
+     *
+     * Every section is aligned to 16 bytes, as Bullet requires of the BVH. Values are stored in native byte order,
+     * and files from a machine with another byte order or from another version are rejected.
+     */
+    class ChunkFile {
+    public:
+        using Buffer = util::aligned_vector<std::byte>;
+
+        /**
+         * Bump whenever the layout or anything the generator produces changes, so stale files are regenerated.
+         */
+        static const std::uint32_t VERSION = 9;
+
+        struct Mesh {
+            GLenum mode = GL_TRIANGLES;
+            const MeshVertex* vertices = nullptr;
+            size_t vertexCount = 0;
+            const unsigned int* indices = nullptr;
+            size_t indexCount = 0;
+
+            glm::vec3 colour{};
+
+            // Both null for meshes without collision triangles. The BVH is built over the unscaled triangles.
+            std::unique_ptr<btTriangleIndexVertexArray> collision;
+            btOptimizedBvh* bvh = nullptr;
+
+            // Inline, so tools that never upload don't link against GL.
+            [[nodiscard]] GLMesh build() const {
+                return GLMeshBuilder::build(mode, vertices, vertexCount, indices, indexCount);
+            }
+        };
+
+    private:
+        // Owns the bytes everything below points into.
+        std::shared_ptr<void> _storage;
+        size_t _size = 0;
+
+        ChunkFile() = default;
+
+    public:
+        unsigned int seed = 0;
+        int x = 0;
+        int y = 0;
+
+        Heightfield heightfield;
+        Mesh roads;
+        std::vector<Mesh> buildings;
+
+        // Not stored. The shared borders a freshly generated chunk was grown from, empty if it was loaded.
+        std::array<std::shared_ptr<const Border>, 4> borders;
+
+        /**
+         * Serialises freshly generated chunk data, building the collision BVHs on the way.
+         */
+        static Buffer serialize(const ChunkData& data);
+
+        /**
+         * Serialises into out a step at a time, writing batch meshes per step. The data must outlive the steps.
+         */
+        static helpers::Steps serialize(const ChunkData& data, Buffer& out, size_t batch);
+
+        /**
+         * Opens the chunk in [bytes, bytes + size), which storage owns. The bytes have to be writable, since Bullet
+         * fixes up the BVHs in place, and aligned to 16 bytes. Returns nullptr if they don't hold a chunk of this
+         * version, or if any index in them points outside its mesh or BVH.
+         */
+        static std::unique_ptr<ChunkFile> open(std::shared_ptr<void> storage, std::byte* bytes, size_t size);
+        static std::unique_ptr<ChunkFile> open(Buffer bytes);
+
+        /**
+         * Keeps the underlying bytes alive, for anything that holds on to the meshes or BVHs after this is gone.
+         */
+        [[nodiscard]] const std::shared_ptr<void>& storage() const;
+
+        /**
+         * Of the underlying bytes.
+         */
+        [[nodiscard]] size_t size() const;
+    };
+}
@@ -1,10 +1,17 @@
 #pragma once
 
-#include "Node.hpp"
+#include "BorderCache.hpp"
+#include "RoadGraph.hpp"
+#include "NodeGrid.hpp"
+#include "Heightfield.hpp"
 #include "PerlinNoise.hpp"
+#include "StageTimes.hpp"
+#include "util/helpers.hpp"
+#include "util/Steps.hpp"
 #include "glm/gtc/constants.hpp"
-#include <random>
+#include <array>
 #include <deque>
+#include <memory>
 
 #include <clipper2/clipper.h>
 
@@ -13,7 +20,8 @@ namespace infd::generator {
     static const float ROAD_WIDTH = 0.005f;
     static const float ROAD_HEIGHT = 0.001f;
 
-    static const float PERLIN_DEPTH = 1.f;
+    // Lattice layer the noise starts on, where the 3D noise once took a slice at z = 1.
+    static const int PERLIN_LAYER = 1;
     static const float MAX_BORDER_ROOTS = 3.2f;
     static const float BORDER_ROOT_PADDING = ROAD_LENGTH * 2;
     static const float BORDER_ROOT_ANGLE = glm::half_pi<float>() / 16;
@@ -22,9 +30,58 @@ namespace infd::generator {
     static const unsigned int MAX_DEPTH = 6;
 
     static const float PERLIN_TERRAIN_FACTOR = 0.07f;
-
-    //TODO: replace with dynamic based on perlin noise?
-    static const unsigned int GENERATION_DEPTH = 25;
+    // Noise behind the terrain heights and behind how many roads cross each chunk edge. Highway density is only
+    // sampled at chunk corners, which lie on lattice points at frequency 1.
+    static const PerlinNoise::Fractal TERRAIN_NOISE = {1, 1.f, 2.f, 0.5f, PERLIN_LAYER};
+    static const PerlinNoise::Fractal HIGHWAY_NOISE = {1, 1.f, 2.f, 0.5f, PERLIN_LAYER};
+    // How built up the area around a chunk is, sampled at its centre to size its GenerationBudget. Varies over a few
+    // chunks, on a layer of its own.
+    static const PerlinNoise::Fractal DENSITY_NOISE = {2, 0.2f, 2.f, 0.5f, PERLIN_LAYER + 1};
+    // Terrain grid cells along each side of a chunk.
+    static const unsigned int TERRAIN_RESOLUTION = 20;
+    // Terrain mesh stride by ring around the centre chunk, the last entry covers every ring beyond. Each must divide
+    // TERRAIN_RESOLUTION.
+    static const unsigned int TERRAIN_LOD_STRIDES[] = {1, 1, 2, 4, 10};
+    // Extra depth of the skirts hiding seams between strides, beyond the worst gap they have to cover.
+    static const float TERRAIN_SKIRT_MARGIN = ROAD_HEIGHT;
+
+    // Rings of far chunks drawn as impostors around the loaded window, see FarChunkData.
+    static const int FAR_CHUNK_RINGS = 12;
+    // Tolerance the footprints of far chunks' blocks are simplified to, in chunks.
+    static const double FAR_BLOCK_TOLERANCE = 0.004;
+
+    // Seconds of travel the loaded area reaches ahead of the followed body, up to all but one ring behind it.
+    static const float STREAMING_LOOKAHEAD = 10.f;
+    // Weight of the distance to the followed body, when ordering chunks equally close to its path.
+    static const float STREAMING_DISTANCE_WEIGHT = 0.25f;
+    // Bounds on the chunks kept parked after moving out of range, in case they come back into it.
+    static const size_t RETAINED_CHUNKS = 32;
+    static const size_t RETAINED_CHUNK_BYTES = size_t(256) << 20;
+    // Bounds on the far chunks kept parked after leaving the rings or being replaced by a chunk of the window, a
+    // little over half of the rings' worth.
+    static const size_t RETAINED_FAR_CHUNKS = 512;
+    static const size_t RETAINED_FAR_CHUNK_BYTES = size_t(32) << 20;
+    // Chunks collide once a moving body's bounds come within this many chunks of them, and stop once none has been
+    // for this many seconds.
+    static const float COLLISION_MARGIN = 0.25f;
+    static const float COLLISION_LINGER = 2.f;
+
+    // Generation budgets of chunks in the sparsest and the densest areas, see GenerationBudget.
+    static const unsigned int MIN_GENERATION_DEPTH = 18;
+    static const unsigned int MAX_GENERATION_DEPTH = 25;
+    static const size_t MIN_NODE_BUDGET = 210;
+    static const size_t MAX_NODE_BUDGET = 240;
+    static const size_t MIN_EDGE_BUDGET = 270;
+    static const size_t MAX_EDGE_BUDGET = 300;
+    static const size_t MIN_CYCLE_BUDGET = 38;
+    static const size_t MAX_CYCLE_BUDGET = 48;
+    static const size_t MIN_BUILDING_TRIANGLE_BUDGET = 4200;
+    static const size_t MAX_BUILDING_TRIANGLE_BUDGET = 5200;
+    // Share of the node budget after which no new branch roads are started, leaving the rest to carry on the roads
+    // already there so they still join up into blocks.
+    static const float BRANCH_BUDGET_SHARE = 0.9f;
+    // Road nodes, buildings or serialised meshes handled per step, when a chunk is generated a step at a time.
+    static const size_t GENERATION_BATCH = 4;
 
     static const unsigned int MAX_CYCLE = 16;
     static const unsigned int MIN_CYCLE = 4;
@@ -36,25 +93,70 @@ namespace infd::generator {
     static const float BUILDING_ROOFCAP_HEIGHT = BUILDING_STOREY_HEIGHT/2;
 
     static const unsigned int MAX_KHRUSHCHEVKA = 8;
-    static std::uniform_int_distribution<int> khrushchevkaDist(5, 20);
+    // Ranges drawn from, both ends inclusive for the integer ones.
+    static const int MIN_KHRUSHCHEVKA_STOREYS = 5;
+    static const int MAX_KHRUSHCHEVKA_STOREYS = 20;
 
-    static std::uniform_real_distribution<float> skyscraperChildrenDist(0.5f, 1.f);
-    static std::uniform_int_distribution<int> skyscraperLayerDist(5, 15);
+    static const float MIN_SKYSCRAPER_CHILD_SCALE = 0.5f;
+    static const float MAX_SKYSCRAPER_CHILD_SCALE = 1.f;
+    static const int MIN_SKYSCRAPER_LAYER_STOREYS = 5;
+    static const int MAX_SKYSCRAPER_LAYER_STOREYS = 15;
 
-    static std::uniform_real_distribution<float> buildingColourDist(0.5f, 1.f);
+    static const float MIN_BUILDING_COLOUR = 0.5f;
+    static const float MAX_BUILDING_COLOUR = 1.f;
 
     static const float SKYSCRAPER_LAYER_CHANCE = 0.7f;
     static const unsigned int MAX_ECCENTRICITY = 2.f;
+    // Building triangles expected of a block, for its budget: per point of the outline for a khrushchevka, and per
+    // block for anything that may be a skyscraper.
+    static const size_t KHRUSHCHEVKA_TRIANGLES_PER_POINT = 9;
+    static const size_t SKYSCRAPER_TRIANGLES = 180;
 
     static const unsigned int MAX_NEIGHBOURS = 4;
     static const float BRANCH_ROAD_CHANCE = 0.2f;
 
-    static std::uniform_real_distribution<float> angleDist(-BORDER_ROOT_ANGLE, BORDER_ROOT_ANGLE);
-    static std::uniform_real_distribution<float> probabilityDist(0, 1);
+    /**
+     * Most work generating a chunk may do, so however the noise falls no chunk takes much longer than the rest. It's
+     * sized by how built up the area is. The network stops growing once it reaches the nodes or edges, starting no new
+     * branches shortly before, and the blocks on the least important roads are left empty once there are more than
+     * the cycles or building triangles allow.
+     */
+    struct GenerationBudget {
+        // Furthest a road grows from a root, in nodes.
+        unsigned int depth = MAX_GENERATION_DEPTH;
+        size_t nodes = MAX_NODE_BUDGET;
+        size_t edges = MAX_EDGE_BUDGET;
+        size_t cycles = MAX_CYCLE_BUDGET;
+        // Estimated from the outline of each block to choose which to mesh, then held to exactly once they're
+        // meshed, see ChunkData.
+        size_t buildingTriangles = MAX_BUILDING_TRIANGLE_BUDGET;
+
+        /**
+         * Budget of a chunk with the given density, from 0 for the sparsest to 1 for the densest.
+         */
+        static GenerationBudget forDensity(float density);
+
+        /**
+         * Building triangles expected of the block with the given outline and bounds.
+         */
+        static size_t estimateTriangles(const Clipper2Lib::PathD& cycle, const Clipper2Lib::RectD& bounds);
+    };
 
     class ChunkGenerator {
     public:
-        ChunkGenerator(int x, int y, unsigned int seed, PerlinNoise& perlinNoise);
+        /**
+         * Border roots are shared through borderCache if given, and generated for this chunk alone otherwise.
+         */
+        ChunkGenerator(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, StageTimes* times = nullptr,
+                       BorderCache* borderCache = nullptr);
+        ChunkGenerator(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, BorderCache* borderCache,
+                       helpers::Deferred);
+
+        /**
+         * Runs the stages of generation one step at a time, for a generator constructed as deferred. It must stay
+         * where it is until they're done.
+         */
+        helpers::Steps generate(StageTimes* times = nullptr);
 
         unsigned int seed;
 
@@ -62,22 +164,60 @@ namespace infd::generator {
         int y;
         PerlinNoise& perlinNoise;
 
-        std::vector<std::shared_ptr<Node>> nodes;
+        // Sampled before anything else, so every later stage can read terrain heights from it.
+        Heightfield heightfield;
+
+        // Up, down, left and right. Held so the cache keeps them while the chunk is around.
+        std::array<std::shared_ptr<const Border>, 4> borders;
+
+        // Set before the network is grown, from the density around the chunk.
+        GenerationBudget budget;
+        // Whether anything was left out of the chunk to stay within budget.
+        bool overBudget = false;
+
+        RoadGraph graph;
         std::vector<Clipper2Lib::PathD> cycles;
-        static float scaledPerlin(float x, float y, PerlinNoise& noise);
+        // Per cycle, in the same order. Area is signed by winding in chunk (x, y) space.
+        std::vector<double> cycleAreas;
+        std::vector<Clipper2Lib::RectD> cycleBounds;
+        // The highest category of the cycle's nodes, the lowest being the most important roads.
+        std::vector<unsigned int> cycleRanks;
+
+        /**
+         * Indices of the cycles in the order they're given the building budget: those whose roads rank highest first
+         * and the largest of those first.
+         */
+        [[nodiscard]] std::vector<size_t> cycleOrder() const;
+
+        static float scaledPerlin(float x, float y, const PerlinNoise& noise, const PerlinNoise::Fractal& fractal);
+        // Batched form of scaledPerlin, with identical results per point.
+        static void scaledPerlin(const float* xs, const float* ys, size_t n, const PerlinNoise& noise,
+                                 const PerlinNoise::Fractal& fractal, float* out);
     private:
+        // Spatial index over nodes, kept in sync with nodes while the network is grown and trimmed.
+        NodeGrid grid{ROAD_LENGTH};
+
+        BorderCache* borderCache;
+
         static float rootDistribution(float value);
+        static float density(int x, int y, const PerlinNoise& perlinNoise);
+
+        std::shared_ptr<const Border> border(int x, int y, Border::Side side) const;
+        static Border generateBorder(int x, int y, Border::Side side, const PerlinNoise& perlinNoise);
 
-        void populateRoots(std::vector<std::shared_ptr<Node>>& roots);
-        void generateNetwork(std::vector<std::shared_ptr<Node>>& roots, unsigned int depth);
+        void populateRoots();
+        void generateNetwork();
         void trimNetwork();
         void sortEdges();
         void findCycles();
+        /**
+         * Drops the cycles that don't fit the budget by their estimated triangles, the last in cycleOrder first.
+         */
+        void fitCycles();
 
-        void addNode(Node* parent, std::deque<Node*>& nodeQueue, helpers::RandomType random, float angleOffset, unsigned int offset);
+        void addNode(NodeIndex parent, std::deque<NodeIndex>& nodeQueue, helpers::RandomType& random, float angleOffset, unsigned int offset);
 
-        static void populateRoots(std::vector<std::shared_ptr<Node>> &roots, float x, float y, unsigned int seed, size_t roadCount,
-                           float angleMultiple,
-                           float (*assignX)(float), float (*assignY)(float));
+        static void populateRoots(RoadGraph& graph, const Border& border, float angleMultiple,
+                                  float (*assignX)(float), float (*assignY)(float));
     };
 }
\ No newline at end of file
@@ -1,16 +1,43 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
 #include <vector>
 #include <random>
+#include <unordered_map>
 #include <BulletCollision/CollisionShapes/btTriangleMesh.h>
+#include <glm/vec2.hpp>
 #include <infd/scene/Scene.hpp>
+#include <infd/scene/physics/physics.hpp>
 #include <infd/render/Renderer.hpp>
+#include "BorderCache.hpp"
 #include "ChunkPtr.hpp"
+#include "ChunkRetentionCache.hpp"
+#include "ChunkWorkerPool.hpp"
+#include "FarChunkPtr.hpp"
 #include "PerlinNoise.hpp"
+#include "TerrainGrids.hpp"
 
 
 namespace infd::generator {
+    /**
+     * Keeps a square window of chunks loaded around a followed body, or the camera if there is none.
+     *
+     * Chunks are generated closest to the body's path first, and at speed the window slides ahead of the body in its
+     * direction of travel, so the world ahead is loaded before it's reached at the cost of the world behind.
+     *
+     * Only chunks near a moving body are in the physics world, so the broadphase only holds what can be hit.
+     *
+     * Beyond the window, FAR_CHUNK_RINGS more rings of chunks are drawn as impostors, see FarChunkData, after every
+     * chunk of the window has been generated. A far chunk moving into the window is drawn until the chunk replacing
+     * it is attached.
+     */
 class ChunkLoader : public infd::scene::Component {
+    public:
+        using Duration = std::chrono::steady_clock::duration;
+
     private:
         int _radius;
 
@@ -22,22 +49,117 @@ class ChunkLoader : public infd::scene::Component {
 
         int _diameter;
         unsigned int _seed;
+
+        const scene::physics::RigidBody* _following = nullptr;
+        // Position of the followed body and how far ahead of it the window reaches, in chunks.
+        glm::vec2 _focus;
+        glm::vec2 _lead{0};
+
         std::vector<ChunkPtr> _chunks;
+        // Generation in flight for each slot of _chunks, indexed the same way.
+        std::vector<std::shared_ptr<ChunkJob>> _jobs;
+        // Seconds since anything moved near each slot's chunk, indexed the same way.
+        std::vector<float> _idle;
+        // Chunks that have left the window, reused if they come back.
+        ChunkRetentionCache<ChunkPtr> _retained{RETAINED_CHUNKS, RETAINED_CHUNK_BYTES};
+
+        struct FarChunk {
+            int x;
+            int y;
+            FarChunkPtr chunk;
+            std::shared_ptr<ChunkJob> job;
+        };
+        // By farKey of their coordinates.
+        std::unordered_map<std::uint64_t, FarChunk> _far;
+        // Far chunks that have left the rings or been replaced by a chunk of the window, reused if they're needed
+        // again rather than generated over.
+        ChunkRetentionCache<FarChunkPtr> _farRetained{RETAINED_FAR_CHUNKS, RETAINED_FAR_CHUNK_BYTES};
 
         PerlinNoise _perlinNoise;
 
+        // Border roots held by the loaded and parked chunks, for their neighbours to grow from.
+        std::shared_ptr<BorderCache> _borders = std::make_shared<BorderCache>();
+
         render::Renderer& _renderer;
+        TerrainGrids _terrainGrids{TERRAIN_RESOLUTION};
+
+        // Declared after _perlinNoise, so that the workers are joined before the noise they read is destroyed.
+        ChunkWorkerPool _workers;
+
+        // Time each frame may spend uploading finished chunks to the GPU and scene.
+        Duration _uploadBudget = std::chrono::milliseconds(4);
 
         void regenAll();
 
         void replace(int x, int y, int xOffset, int yOffset);
 
+        size_t slot(int x, int y) const;
+        // Terrain stride for the chunk at window position (x, y), by its ring around the focus.
+        unsigned int lod(int x, int y) const;
+        // Of the chunk at (x, y), lower for chunks closer to the path ahead of the focus. Far chunks come after every
+        // chunk of the window.
+        float priority(int x, int y, ChunkJob::Detail detail = ChunkJob::Detail::Full) const;
+        static std::uint64_t farKey(int x, int y);
+        // Submits far chunks for the rings around the window, unless they're parked, and parks those outside them or
+        // already replaced by a chunk of the window.
+        void updateFar();
+        void dropFar(int x, int y);
+        void updateLods();
+        // Adds chunks near moving bodies to the physics world, and removes those left alone for long enough.
+        void updateCollision(float deltaTime);
+        void attach(std::shared_ptr<ChunkJob>& job, scene::SceneObject& parent);
+
     public:
-        ChunkLoader(scene::SceneObject& scene, render::Renderer& renderer, int radius, unsigned int seed = 0, int x = 0, int y = 0);
+        /**
+         * Chunks are kept in a ChunkCache under cacheDirectory, unless it's empty.
+         */
+        ChunkLoader(scene::SceneObject& scene, render::Renderer& renderer, int radius, unsigned int seed = 0, int x = 0, int y = 0,
+                    const std::filesystem::path& cacheDirectory = {});
         ChunkPtr& operator()(int x, int y);
+
+        /**
+         * Streams chunks around body, or around the camera if null. The body has to outlive this loader.
+         */
+        void follow(const scene::physics::RigidBody* body) noexcept;
+        [[nodiscard]] const scene::physics::RigidBody* following() const noexcept;
+
         void move(int x, int y);
         void center(float x, float y);
         void detachAll();
+
+        /**
+         * Attaches finished chunks until the budget for this frame runs out. At least one chunk is attached per call
+         * if any are ready. Without worker threads, the rest of the budget goes on generating chunks, at least a
+         * step of it per call.
+         */
+        void upload(Duration budget);
+
+        /**
+         * Blocks until every requested chunk has been generated and attached.
+         */
+        void flush();
+
+        /**
+         * Height of the terrain surface at a world position, read from the cached heightfield of the chunk
+         * underneath. Chunks that aren't loaded yet are sampled directly instead.
+         */
+        [[nodiscard]] float heightAt(float worldX, float worldZ) const;
+
+        /**
+         * Distance from the focus to the farthest corner of the far rings, in world units.
+         */
+        [[nodiscard]] float horizon() const;
+
+        [[nodiscard]] Duration uploadBudget() const;
+        void uploadBudget(Duration budget);
+
+        /**
+         * Shows how well parked chunks and shared borders are being reused, how many chunks collide, and what the far
+         * chunks take.
+         */
+        void gui();
+
         void onFrameUpdate() override;
+        void onPhysicsUpdate() override;
     };
 }
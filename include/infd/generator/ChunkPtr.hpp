@@ -1,19 +1,98 @@
 #pragma once
 
-#include "ChunkGenerator.hpp"
+#include "ChunkFile.hpp"
+#include "Heightfield.hpp"
+#include "TerrainGrids.hpp"
 #include "infd/scene/Scene.hpp"
 #include "infd/render/Renderer.hpp"
+#include "infd/render/RenderComponent.hpp"
 
 namespace infd::generator {
     class ChunkPtr {
-        bool _detached = false;
+        // Collision triangles of a mesh, and the object its body goes on once it's needed.
+        struct CollisionMesh {
+            scene::SceneObject* object;
+            std::unique_ptr<btTriangleIndexVertexArray> triangles;
+            btOptimizedBvh* bvh;
+        };
 
-        scene::SceneObject* _chunkScenePointer;
+        bool _detached = true;
+        bool _parked = false;
+        bool _colliding = false;
+        bool _collisionBuilt = false;
+
+        int _x = 0;
+        int _y = 0;
+        // Rough memory held by the chunk, on the GPU and in its file.
+        size_t _bytes = 0;
+
+        scene::SceneObject* _chunkScenePointer = nullptr;
+
+        Heightfield _heightfield;
+        // Keeps the borders it was generated from shared with its neighbours.
+        std::array<std::shared_ptr<const Border>, 4> _borders;
+
+        // Draws a grid shared by every chunk, lifted by a texture of this chunk's heights.
+        render::RenderComponent* _terrain = nullptr;
+        TerrainGrids* _grids = nullptr;
+        unsigned int _lod = 1;
+
+        // Kept until the collision is built, along with the file memory it reads from.
+        std::vector<CollisionMesh> _collisionMeshes;
+        std::shared_ptr<void> _storage;
+
+        void buildCollision();
 
     public:
-        ChunkPtr(scene::SceneObject& scene, render::Renderer& renderer, ChunkGenerator& generator);
-        ChunkPtr(scene::Component& parent, render::Renderer& renderer, ChunkGenerator& generator);
+        // An empty chunk, e.g. one still being generated.
+        ChunkPtr() = default;
+
+        /**
+         * Uploads the given chunk to the GPU and attaches it to the scene, drawing its terrain with the grids' grid
+         * of the given stride. Collision keeps using the file's memory, and keeps its storage alive, until detached.
+         * It isn't built until the chunk first collides. Must be called on the main thread.
+         */
+        ChunkPtr(scene::SceneObject& scene, render::Renderer& renderer, TerrainGrids& grids, ChunkFile& file,
+                 unsigned int stride = 1);
+        ChunkPtr(scene::Component& parent, render::Renderer& renderer, TerrainGrids& grids, ChunkFile& file,
+                 unsigned int stride = 1);
+
+        [[nodiscard]] bool detached() const;
+        [[nodiscard]] bool parked() const;
+
+        [[nodiscard]] int x() const;
+        [[nodiscard]] int y() const;
+        [[nodiscard]] size_t bytes() const;
+
+        /**
+         * The terrain heights of this chunk, or nullptr if it's detached.
+         */
+        [[nodiscard]] const Heightfield* heightfield() const;
+
+        [[nodiscard]] unsigned int lod() const;
+
+        /**
+         * Draws the terrain with the grid of the given stride. Only the grid changes, the heights stay uploaded, and
+         * collision always stays at full resolution. Must be called on the main thread.
+         */
+        void lod(unsigned int stride);
+
+        [[nodiscard]] bool colliding() const;
+
+        /**
+         * Adds or removes the chunk's static bodies from the physics world, building them the first time. Must be
+         * called on the main thread.
+         */
+        void colliding(bool value);
+
+        /**
+         * Hides the chunk and takes it out of the physics world, keeping everything it uploaded, so unpark can bring
+         * it back at no cost. Unparking leaves it out of the physics world until it's next needed there. Must be
+         * called on the main thread.
+         */
+        void park();
+        void unpark();
 
         void detach();
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+namespace infd::generator {
+    /**
+     * Chunks recently moved out of range, parked so they can be reused instead of regenerated if they come back into
+     * range. Bounded by both a number of chunks and their total bytes(), dropping the least recently parked first.
+     *
+     * Chunk is a ChunkPtr or a FarChunkPtr: anything with x(), y(), bytes(), park(), unpark(), detach() and
+     * detached(). Chunks are parked on the way in and detached when dropped. Must only be used on the main thread.
+     */
+    template<class Chunk>
+    class ChunkRetentionCache {
+        size_t _maxChunks;
+        size_t _maxBytes;
+
+        // Most recently parked first.
+        std::list<Chunk> _chunks;
+        std::unordered_map<std::uint64_t, typename std::list<Chunk>::iterator> _index;
+        size_t _bytes = 0;
+
+        size_t _hits = 0;
+        size_t _misses = 0;
+
+        static std::uint64_t key(int x, int y);
+        void dropOldest();
+
+    public:
+        ChunkRetentionCache(size_t maxChunks, size_t maxBytes);
+
+        /**
+         * Parks chunk, dropping the oldest chunks while over either bound. Detached chunks are ignored.
+         */
+        void put(Chunk chunk);
+
+        /**
+         * Removes and unparks the chunk at (x, y). Returns a detached Chunk if it isn't held.
+         */
+        [[nodiscard]] Chunk take(int x, int y);
+
+        /**
+         * Detaches every chunk held.
+         */
+        void clear();
+
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] size_t bytes() const;
+        [[nodiscard]] size_t hits() const;
+        [[nodiscard]] size_t misses() const;
+    };
+
+    template<class Chunk>
+    ChunkRetentionCache<Chunk>::ChunkRetentionCache(size_t maxChunks, size_t maxBytes) :
+        _maxChunks(maxChunks), _maxBytes(maxBytes) {}
+
+    template<class Chunk>
+    std::uint64_t ChunkRetentionCache<Chunk>::key(int x, int y) {
+        return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+    }
+
+    template<class Chunk>
+    void ChunkRetentionCache<Chunk>::dropOldest() {
+        Chunk& oldest = _chunks.back();
+        _index.erase(key(oldest.x(), oldest.y()));
+        _bytes -= oldest.bytes();
+
+        oldest.detach();
+        _chunks.pop_back();
+    }
+
+    template<class Chunk>
+    void ChunkRetentionCache<Chunk>::put(Chunk chunk) {
+        if (chunk.detached()) return;
+
+        // Can't happen while the loader only parks chunks it owns, but don't leak the old one if it does.
+        auto existing = _index.find(key(chunk.x(), chunk.y()));
+        if (existing != _index.end()) {
+            _bytes -= existing->second->bytes();
+            existing->second->detach();
+            _chunks.erase(existing->second);
+            _index.erase(existing);
+        }
+
+        chunk.park();
+        _bytes += chunk.bytes();
+        _chunks.push_front(std::move(chunk));
+        _index[key(_chunks.front().x(), _chunks.front().y())] = _chunks.begin();
+
+        while (!_chunks.empty() && (_chunks.size() > _maxChunks || _bytes > _maxBytes)) {
+            dropOldest();
+        }
+    }
+
+    template<class Chunk>
+    Chunk ChunkRetentionCache<Chunk>::take(int x, int y) {
+        auto found = _index.find(key(x, y));
+        if (found == _index.end()) {
+            _misses++;
+            return {};
+        }
+        _hits++;
+
+        Chunk chunk = std::move(*found->second);
+        _bytes -= chunk.bytes();
+        _chunks.erase(found->second);
+        _index.erase(found);
+
+        chunk.unpark();
+        return chunk;
+    }
+
+    template<class Chunk>
+    void ChunkRetentionCache<Chunk>::clear() {
+        for (Chunk& chunk : _chunks) {
+            chunk.detach();
+        }
+        _chunks.clear();
+        _index.clear();
+        _bytes = 0;
+    }
+
+    template<class Chunk>
+    size_t ChunkRetentionCache<Chunk>::size() const {
+        return _chunks.size();
+    }
+
+    template<class Chunk>
+    size_t ChunkRetentionCache<Chunk>::bytes() const {
+        return _bytes;
+    }
+
+    template<class Chunk>
+    size_t ChunkRetentionCache<Chunk>::hits() const {
+        return _hits;
+    }
+
+    template<class Chunk>
+    size_t ChunkRetentionCache<Chunk>::misses() const {
+        return _misses;
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ChunkCache.hpp"
+#include "ChunkFile.hpp"
+#include "FarChunkData.hpp"
+#include "PerlinNoise.hpp"
+#include "util/Steps.hpp"
+
+namespace infd::generator {
+    /**
+     * A single chunk generation request. Owned jointly by the pool and whoever submitted it.
+     */
+    class ChunkJob {
+        friend class ChunkWorkerPool;
+
+        std::exception_ptr _exception;
+        // Breaks ties between equal priorities in submission order.
+        std::uint64_t _sequence = 0;
+        // How far generation has got, when it's being run a step at a time.
+        helpers::Steps _steps;
+
+    public:
+        enum class Detail {
+            // The whole chunk, into data.
+            Full,
+            // Only its impostor, into far. Never cached.
+            Far
+        };
+
+        const int x;
+        const int y;
+        const Detail detail;
+
+        // Queued jobs with a lower priority are started first. Only changed through ChunkWorkerPool::reprioritize
+        // once submitted.
+        float priority = 0;
+
+        std::atomic<bool> cancelled = false;
+
+        // Only valid once the job has been returned by ChunkWorkerPool::poll or ChunkWorkerPool::wait.
+        std::unique_ptr<ChunkFile> data;
+        std::unique_ptr<FarChunkData> far;
+
+        ChunkJob(int x, int y, Detail detail = Detail::Full) : x(x), y(y), detail(detail) {}
+
+        void cancel() { cancelled = true; }
+
+        /**
+         * Rethrows any exception raised while generating this chunk on the worker thread.
+         */
+        void rethrow() const { if (_exception) std::rethrow_exception(_exception); }
+    };
+
+    /**
+     * Produces chunks on a set of worker threads, loading them from the cache if one is given and generating them
+     * otherwise. Far jobs generate just the chunk's impostor, see FarChunkData. Completed jobs are collected by the
+     * owning thread with poll or wait, which is where the GL upload should happen.
+     *
+     * A pool without worker threads, the default on a single core, generates on the owning thread instead, a step at
+     * a time whenever step is given time to. Generation paused between steps is dropped as soon as its job is
+     * cancelled.
+     *
+     * Queued jobs are started in order of priority, then of submission.
+     */
+    class ChunkWorkerPool {
+    public:
+        using Duration = std::chrono::steady_clock::duration;
+
+    private:
+        unsigned int _seed;
+        PerlinNoise& _perlinNoise;
+        std::shared_ptr<const ChunkCache> _cache;
+        std::shared_ptr<BorderCache> _borders;
+
+        std::vector<std::thread> _workers;
+
+        // Heap ordered by startsAfter, so the front is the next job to start.
+        std::vector<std::shared_ptr<ChunkJob>> _queue;
+        std::deque<std::shared_ptr<ChunkJob>> _completed;
+        // The job step is part way through, without worker threads.
+        std::shared_ptr<ChunkJob> _current;
+        std::uint64_t _submitted = 0;
+        size_t _running = 0;
+        bool _stopping = false;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _queueCondition;
+        std::condition_variable _completedCondition;
+
+        static bool startsAfter(const std::shared_ptr<ChunkJob>& a, const std::shared_ptr<ChunkJob>& b);
+
+        void work();
+        // Loads or generates the job's chunk into it, batch road nodes, buildings or meshes per step.
+        helpers::Steps generate(ChunkJob& job, size_t batch) const;
+        std::shared_ptr<ChunkJob> popCompleted();
+
+    public:
+        /**
+         * Freshly generated chunks are written to cache, if given, which has to be for the same seed. They share
+         * their border roots through borders, if given.
+         */
+        ChunkWorkerPool(unsigned int seed, PerlinNoise& perlinNoise, std::shared_ptr<const ChunkCache> cache = nullptr,
+                        std::shared_ptr<BorderCache> borders = nullptr, unsigned int threadCount = defaultThreadCount());
+        ~ChunkWorkerPool();
+
+        ChunkWorkerPool(const ChunkWorkerPool&) = delete;
+        ChunkWorkerPool& operator=(const ChunkWorkerPool&) = delete;
+
+        std::shared_ptr<ChunkJob> submit(int x, int y, float priority = 0, ChunkJob::Detail detail = ChunkJob::Detail::Full);
+
+        /**
+         * Sets the priority of every job still queued to priority(job).
+         */
+        template <typename Fn>
+        void reprioritize(Fn&& priority);
+
+        /**
+         * Returns a completed job, or nullptr if none are ready. Never blocks.
+         */
+        std::shared_ptr<ChunkJob> poll();
+
+        /**
+         * Blocks until a job completes. Returns nullptr once nothing is queued, running or awaiting collection.
+         * Without worker threads, generates on the calling thread until then.
+         */
+        std::shared_ptr<ChunkJob> wait();
+
+        /**
+         * Without worker threads, generates queued jobs a step at a time until budget runs out, taking at least one
+         * step if there's anything to generate. Does nothing with them.
+         */
+        void step(Duration budget);
+
+        [[nodiscard]] size_t pending() const;
+
+        static unsigned int defaultThreadCount();
+    };
+
+    template <typename Fn>
+    void ChunkWorkerPool::reprioritize(Fn&& priority) {
+        std::lock_guard lock(_mutex);
+        for (std::shared_ptr<ChunkJob>& job : _queue) {
+            job->priority = priority(static_cast<const ChunkJob&>(*job));
+        }
+        std::make_heap(_queue.begin(), _queue.end(), startsAfter);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include "glm/vec3.hpp"
+#include "infd/GLMesh.hpp"
+#include "BorderCache.hpp"
+#include "ChunkGenerator.hpp"
+#include "PerlinNoise.hpp"
+#include "util/Steps.hpp"
+
+namespace infd::generator {
+    /**
+     * The impostor a chunk beyond the loaded window is drawn as: its terrain on the coarsest grid, and every building
+     * as a block of one colour, merged into a single mesh so the chunk is a single draw. Only this is kept of the
+     * chunk, there are no roads and nothing to collide with. Safe to construct off the main thread.
+     */
+    class FarChunkData {
+        // Only held while generating.
+        std::unique_ptr<ChunkGenerator> _generator;
+
+    public:
+        int x;
+        int y;
+
+        // Terrain vertices have texture coordinates (0, 0), and block vertices (1, 0), see
+        // RenderComponent::material.secondary_colour.
+        GLMeshBuilder mesh;
+        // Mean of the building colours.
+        glm::vec3 colour{};
+
+        // The shared borders it was grown from, kept for the chunks around it.
+        std::array<std::shared_ptr<const Border>, 4> borders;
+
+        /**
+         * Generates the chunk at the given location as ChunkData would, but only as far as the blocks. Generation
+         * stops early once cancelled is set, in which case the data should be discarded. Border roots are shared
+         * through borderCache, if given.
+         */
+        FarChunkData(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, const std::atomic<bool>& cancelled,
+                     BorderCache* borderCache = nullptr);
+        FarChunkData(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, BorderCache* borderCache,
+                     helpers::Deferred);
+
+        /**
+         * Generates the chunk a step at a time, for data constructed as deferred: a step per stage of the generator,
+         * and per batch blocks. The data must stay where it is until they're done.
+         */
+        helpers::Steps generate(const std::atomic<bool>& cancelled, size_t batch);
+
+        /**
+         * Bytes the chunk takes once uploaded.
+         */
+        [[nodiscard]] size_t bytes() const;
+    };
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "FarChunkData.hpp"
+#include "infd/scene/Scene.hpp"
+#include "infd/render/Renderer.hpp"
+
+namespace infd::generator {
+    /**
+     * A far chunk in the scene, drawn as the one mesh of its terrain and blocks. It casts no shadows, and nothing
+     * collides with it.
+     */
+    class FarChunkPtr {
+        bool _detached = true;
+        bool _parked = false;
+
+        int _x = 0;
+        int _y = 0;
+        // Rough memory held by the chunk on the GPU.
+        size_t _bytes = 0;
+
+        scene::SceneObject* _chunkScenePointer = nullptr;
+
+        // Keeps the borders it was generated from shared with its neighbours.
+        std::array<std::shared_ptr<const Border>, 4> _borders;
+
+    public:
+        // An empty chunk, e.g. one still being generated.
+        FarChunkPtr() = default;
+
+        /**
+         * Uploads the given chunk to the GPU and attaches it to the scene. Must be called on the main thread.
+         */
+        FarChunkPtr(scene::SceneObject& scene, render::Renderer& renderer, FarChunkData& data);
+
+        [[nodiscard]] bool detached() const;
+        [[nodiscard]] bool parked() const;
+
+        [[nodiscard]] int x() const;
+        [[nodiscard]] int y() const;
+        [[nodiscard]] size_t bytes() const;
+
+        /**
+         * Hides the chunk, keeping what it uploaded, so unpark can bring it back at no cost. Must be called on the main
+         * thread.
+         */
+        void park();
+        void unpark();
+
+        void detach();
+    };
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <glm/vec3.hpp>
+#include "PerlinNoise.hpp"
+
+namespace infd::generator {
+    /**
+     * Terrain heights of a single chunk, sampled once on a regular grid and then queried by interpolation.
+     *
+     * Vertices 0 to resolution span the chunk in each axis, so the edge vertices land on exactly the same positions
+     * as those of the neighbouring chunk. One extra ring of vertices is kept outside the chunk, for anything that
+     * needs to look across a seam.
+     */
+    class Heightfield {
+        unsigned int _resolution = 0;
+        // Vertices per row, including the border.
+        unsigned int _stride = 0;
+
+        // Row-major in y, starting from vertex (-1, -1).
+        std::vector<float> _heights;
+
+        // A position within a grid cell, by the sample at its lower corner and how far across it it is.
+        struct Cell {
+            unsigned int i;
+            unsigned int j;
+            float tx;
+            float ty;
+        };
+
+        /**
+         * Where along an axis of chunk the sample at index i lies, counting from the border.
+         */
+        static float coordinate(int chunk, unsigned int i, unsigned int resolution);
+
+        /**
+         * The cell of a bordered grid holding a chunk-local position, clamped to the grid.
+         */
+        static Cell locate(float x, float y, unsigned int resolution);
+
+        static float interpolate(float lowerLeft, float lowerRight, float upperLeft, float upperRight, const Cell& cell);
+
+    public:
+        Heightfield() = default;
+        Heightfield(int x, int y, unsigned int resolution, const PerlinNoise& noise);
+
+        /**
+         * Wraps samples taken earlier, laid out the way samples() returns them.
+         */
+        Heightfield(unsigned int resolution, std::vector<float> samples);
+
+        [[nodiscard]] unsigned int resolution() const;
+
+        /**
+         * Height of grid vertex (i, j), where -1 and resolution+1 are the border.
+         */
+        [[nodiscard]] float vertex(int i, int j) const;
+
+        /**
+         * Heights of vertices 0 to resolution in each axis, without the border, row-major in y.
+         */
+        [[nodiscard]] std::vector<float> heights() const;
+
+        /**
+         * Every sample including the border, row-major in y starting from vertex (-1, -1).
+         */
+        [[nodiscard]] const std::vector<float>& samples() const;
+
+        /**
+         * Surface normal at grid vertex (i, j) by central differences, which reach into the border at the edges.
+         * Valid for 0 to resolution, in the same chunk-local space as the mesh (grid j runs along z).
+         */
+        [[nodiscard]] glm::vec3 normal(int i, int j) const;
+
+        /**
+         * Bilinearly interpolated height at a chunk-local position, clamped to the bordered grid.
+         */
+        [[nodiscard]] float sample(float x, float y) const;
+
+        /**
+         * The same height sample(x, y) gives on Heightfield(chunkX, chunkY, resolution, noise), from only the four
+         * samples around it, for points in chunks that aren't otherwise sampled.
+         */
+        [[nodiscard]] static float sample(int chunkX, int chunkY, unsigned int resolution, const PerlinNoise& noise,
+                                          float x, float y);
+    };
+}
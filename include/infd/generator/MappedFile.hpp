@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+namespace infd::generator {
+    /**
+     * A whole file mapped into memory copy-on-write. Pages are only read from disk once touched, and writes to the
+     * mapping stay private to this process rather than reaching the file.
+     */
+    class MappedFile {
+        std::byte* _data = nullptr;
+        size_t _size = 0;
+
+        MappedFile(std::byte* data, size_t size);
+
+    public:
+        /**
+         * Maps the file at path, or returns nullptr if it doesn't exist, is empty or can't be mapped.
+         */
+        static std::unique_ptr<MappedFile> open(const std::filesystem::path& path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        [[nodiscard]] std::byte* data() const;
+        [[nodiscard]] size_t size() const;
+    };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include "RoadGraph.hpp"
+
+namespace infd::generator {
+    /**
+     * Uniform grid over the unit chunk square, used to accelerate nearest node queries while growing the network.
+     * Cells are ROAD_LENGTH wide, so a query around a freshly placed node only touches its immediate neighbourhood.
+     */
+    class NodeGrid {
+        unsigned int _size;
+        float _cellSize;
+
+        std::vector<std::vector<NodeIndex>> _cells;
+
+        [[nodiscard]] int cellIndex(float value) const;
+        [[nodiscard]] std::vector<NodeIndex>& cell(float x, float y);
+
+    public:
+        explicit NodeGrid(float cellSize);
+
+        void insert(const RoadGraph& graph, NodeIndex node);
+        void remove(const RoadGraph& graph, NodeIndex node);
+
+        /**
+         * Renumbers the indexed nodes after RoadGraph::compact, dropping removed ones.
+         */
+        void remap(const std::vector<NodeIndex>& remap);
+
+        /**
+         * Finds the node nearest to (x, y) that is strictly closer than initial, or initial if there is none.
+         * Ties go to the lowest index, matching a linear scan over the graph in order.
+         */
+        [[nodiscard]] NodeIndex findNearest(const RoadGraph& graph, float x, float y, NodeIndex initial) const;
+    };
+}
@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <numeric>
 #include "infd/generator/util/helpers.hpp"
 
@@ -22,12 +24,78 @@ namespace infd::generator {
         template<class T>
         static T grad(int hash, T x, T y, T z);
 
+        // The gradients of grad() at z = 0.
+        template<class T>
+        static T grad(int hash, T x, T y);
+
+        // Batched 2D sample(), for the fractal sampleN to build on.
+        void sampleLayer(const float* xs, const float* ys, int layer, size_t n, float* out) const;
+
     public:
+        /**
+         * Instruction sets the batch sampling functions can use. All produce identical results.
+         */
+        enum class Kernel {
+            Scalar,
+            Sse2,
+            Avx2
+        };
+
+        /**
+         * Octaves of 2D noise summed into fractal Brownian motion. Octave i is sampled at frequency * lacunarity^i
+         * with amplitude gain^i, on lattice layer layer + i so the octaves don't line up. The sum isn't normalised, so
+         * a single octave at frequency 1 is plain sample(x, y, layer).
+         */
+        struct Fractal {
+            unsigned int octaves = 1;
+            float frequency = 1;
+            float lacunarity = 2;
+            float gain = 0.5f;
+            int layer = 0;
+        };
+
         inline PerlinNoise();
         inline PerlinNoise(unsigned int seed);
 
         template<class T>
-        T sample(T x, T y, T z);
+        T sample(T x, T y, T z) const;
+
+        /**
+         * 2D noise on one layer of the lattice. Equal to sample(x, y, layer) for the 3D noise, for half the gradients
+         * and lerps.
+         */
+        template<class T>
+        T sample(T x, T y, int layer = 0) const;
+
+        template<class T>
+        T sample(T x, T y, const Fractal& fractal) const;
+
+        /**
+         * Samples n points at (xs[i], ys[i], z) into out. Bit-identical to calling sample<float> per point.
+         */
+        void sampleN(const float* xs, const float* ys, float z, size_t n, float* out) const;
+
+        /**
+         * Samples n points of fractal 2D noise into out. Bit-identical to calling sample<float> per point.
+         */
+        void sampleN(const float* xs, const float* ys, size_t n, const Fractal& fractal, float* out) const;
+
+        /**
+         * Samples a w by h grid of points at (x0 + i*dx, y0 + j*dy, z) into out, row by row: out[j*w + i].
+         */
+        void sampleGrid(float x0, float y0, float dx, float dy, size_t w, size_t h, float z, float* out) const;
+
+        /**
+         * The best kernel supported by this CPU, unless overridden.
+         */
+        static Kernel kernel();
+
+        /**
+         * Overrides the kernel used by the batch functions. Falls back to the best supported one if unavailable.
+         */
+        static void kernel(Kernel value);
+
+        static bool supported(Kernel value);
     };
 
     template<class T>
@@ -48,6 +116,14 @@ namespace infd::generator {
         return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
     }
 
+    template<class T>
+    T PerlinNoise::grad(int hash, T x, T y) {
+        int h = hash & 15;
+        T u = h < 8 ? x : y;
+        T v = h < 4 ? y : h == 12 || h == 14 ? x : T(0);
+        return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+    }
+
     PerlinNoise::PerlinNoise(unsigned int seed) {
         _permutationVector.resize(256);
 
@@ -55,7 +131,7 @@ namespace infd::generator {
 
         helpers::RandomType random(seed);
 
-        std::shuffle(_permutationVector.begin(), _permutationVector.end(), random);
+        helpers::shuffle(_permutationVector.begin(), _permutationVector.end(), random);
 
         _permutationVector.insert(
                 _permutationVector.end(),
@@ -67,7 +143,7 @@ namespace infd::generator {
     PerlinNoise::PerlinNoise() = default;
 
     template<class T>
-    T PerlinNoise::sample(T x, T y, T z) {
+    T PerlinNoise::sample(T x, T y, T z) const {
         int x_unit = (int) floor(x) & 255;
         int y_unit = (int) floor(y) & 255;
         int z_unit = (int) floor(z) & 255;
@@ -94,4 +170,41 @@ namespace infd::generator {
                          lerp(u, grad(_permutationVector[ab + 1], x, y - 1, z - 1),
                               grad(_permutationVector[bb + 1], x - 1, y - 1, z - 1))));
     }
-}
\ No newline at end of file
+
+    template<class T>
+    T PerlinNoise::sample(T x, T y, int layer) const {
+        int x_unit = (int) floor(x) & 255;
+        int y_unit = (int) floor(y) & 255;
+        int z_unit = layer & 255;
+        x -= floor(x);
+        y -= floor(y);
+        T u = fade(x);
+        T v = fade(y);
+
+        int a = _permutationVector[x_unit] + y_unit;
+        int aa = _permutationVector[a] + z_unit;
+        int ab = _permutationVector[a + 1] + z_unit;
+        int b = _permutationVector[x_unit + 1] + y_unit;
+        int ba = _permutationVector[b] + z_unit;
+        int bb = _permutationVector[b + 1] + z_unit;
+
+        return lerp(v, lerp(u, grad(_permutationVector[aa], x, y),
+                            grad(_permutationVector[ba], x - 1, y)),
+                    lerp(u, grad(_permutationVector[ab], x, y - 1),
+                         grad(_permutationVector[bb], x - 1, y - 1)));
+    }
+
+    template<class T>
+    T PerlinNoise::sample(T x, T y, const Fractal& fractal) const {
+        T sum = 0;
+        T frequency = fractal.frequency;
+        T amplitude = 1;
+
+        for (unsigned int octave = 0; octave < fractal.octaves; octave++) {
+            sum += amplitude * sample<T>(x * frequency, y * frequency, fractal.layer + static_cast<int>(octave));
+            frequency *= fractal.lacunarity;
+            amplitude *= fractal.gain;
+        }
+        return sum;
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define INFD_PERLIN_X86
+#endif
+
+namespace infd::generator::kernels {
+    /*
+     * Vectorised PerlinNoise::sample<float> over n points with a shared z, or for the 2D kernels a shared layer. Each kernel processes as many whole
+     * vectors as fit in n and returns how many points it wrote; the caller finishes the remainder.
+     *
+     * The AVX2 kernel lives in its own translation unit built with AVX2 enabled, and must only be called once
+     * hasAvx2() has confirmed support.
+     */
+#ifdef INFD_PERLIN_X86
+    size_t perlinSse2(const int* permutation, const float* xs, const float* ys, float z, size_t n, float* out);
+    size_t perlinAvx2(const int* permutation, const float* xs, const float* ys, float z, size_t n, float* out);
+    size_t perlin2Sse2(const int* permutation, const float* xs, const float* ys, int layer, size_t n, float* out);
+    size_t perlin2Avx2(const int* permutation, const float* xs, const float* ys, int layer, size_t n, float* out);
+
+    bool hasAvx2();
+#endif
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace infd::generator {
+    using NodeIndex = std::uint32_t;
+    using EdgeIndex = std::uint32_t;
+
+    static const NodeIndex NO_NODE = std::numeric_limits<NodeIndex>::max();
+    static const EdgeIndex NO_EDGE = std::numeric_limits<EdgeIndex>::max();
+
+    /**
+     * Road network of a single chunk, stored as flat arrays indexed by 32 bit node and edge indices.
+     *
+     * While the network is grown, edges are appended in twin pairs and each node chains its outgoing half-edges in a
+     * linked list. removeNode only leaves a tombstone. compact() then drops the tombstones in one pass and lays the
+     * edges out contiguously per node, so node n owns edges [edgeOffset[n], edgeOffset[n+1]).
+     *
+     * Once sorted, the edges form a half-edge structure: edgeNext[e] is the edge leaving edgeTo[e] that follows
+     * edgeTwin[e] in angular order, so repeatedly following edgeNext walks around a city block.
+     */
+    class RoadGraph {
+        // Build phase adjacency, discarded by compact().
+        std::vector<EdgeIndex> _firstEdge;
+        std::vector<EdgeIndex> _nextEdge;
+        std::vector<std::uint8_t> _removed;
+
+    public:
+        // Per node attributes.
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> angle;
+        std::vector<unsigned int> depth;
+        std::vector<unsigned int> category;
+        std::vector<std::uint8_t> isRoot;
+        std::vector<unsigned int> degree;
+
+        // Per half-edge attributes.
+        std::vector<NodeIndex> edgeFrom;
+        std::vector<NodeIndex> edgeTo;
+        std::vector<float> edgeAngle;
+        std::vector<EdgeIndex> edgeTwin;
+        std::vector<std::uint8_t> edgeVisited;
+        // Only valid after sortEdges().
+        std::vector<EdgeIndex> edgeNext;
+
+        // Only valid after compact().
+        std::vector<EdgeIndex> edgeOffset;
+
+        [[nodiscard]] size_t size() const { return x.size(); }
+        [[nodiscard]] size_t edgeCount() const { return edgeTo.size(); }
+
+        [[nodiscard]] EdgeIndex edgesBegin(NodeIndex node) const { return edgeOffset[node]; }
+        [[nodiscard]] EdgeIndex edgesEnd(NodeIndex node) const { return edgeOffset[node + 1]; }
+
+        [[nodiscard]] float sqDist(NodeIndex node, float x_, float y_) const;
+
+        NodeIndex addNode(float x_, float y_, float angle_, bool isRoot_ = true, unsigned int depth_ = 1, unsigned int category_ = 0);
+
+        /**
+         * Adds a half-edge in each direction between a and b.
+         */
+        void addEdge(NodeIndex a, NodeIndex b);
+
+        [[nodiscard]] bool connected(NodeIndex a, NodeIndex b) const;
+
+        /**
+         * Tombstones the node and detaches it from its neighbours, which are passed to onNeighbour.
+         */
+        template <typename Fn>
+        void removeNode(NodeIndex node, Fn&& onNeighbour);
+
+        /**
+         * Drops removed nodes and edges, renumbering the remainder in order. Returns the new index of every old node,
+         * or NO_NODE for removed ones.
+         */
+        std::vector<NodeIndex> compact();
+
+        /**
+         * Sorts each node's edges by angle, keeping twins consistent, and links each edge to its successor around
+         * its face. Requires compact().
+         */
+        void sortEdges();
+    };
+
+    template <typename Fn>
+    void RoadGraph::removeNode(NodeIndex node, Fn&& onNeighbour) {
+        _removed[node] = true;
+
+        for (EdgeIndex e = _firstEdge[node]; e != NO_EDGE; e = _nextEdge[e]) {
+            NodeIndex to = edgeTo[e];
+            if (to == NO_NODE) continue;
+
+            edgeTo[e] = NO_NODE;
+            edgeTo[edgeTwin[e]] = NO_NODE;
+            degree[node]--;
+            degree[to]--;
+
+            onNeighbour(to);
+        }
+    }
+}
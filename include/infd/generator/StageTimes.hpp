@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <utility>
+#include "util/Steps.hpp"
+
+namespace infd::generator {
+    /**
+     * Wall time spent in each stage of generating a chunk. Only filled in when passed to ChunkData or ChunkGenerator,
+     * which otherwise never read the clock. Times add up, so one instance can collect over several chunks.
+     */
+    struct StageTimes {
+        using Clock = std::chrono::steady_clock;
+        using Duration = Clock::duration;
+
+        Duration heightfield{};
+        Duration populateRoots{};
+        Duration generateNetwork{};
+        Duration trimNetwork{};
+        Duration sortEdges{};
+        Duration findCycles{};
+        Duration roadMesh{};
+        Duration buildingMeshes{};
+
+        /**
+         * Runs stage, adding the time it took to the given field of times if there are any.
+         */
+        template <typename Fn>
+        static void time(StageTimes* times, Duration StageTimes::* field, Fn&& stage) {
+            if (!times) {
+                std::forward<Fn>(stage)();
+                return;
+            }
+
+            Clock::time_point start = Clock::now();
+            std::forward<Fn>(stage)();
+            times->*field += Clock::now() - start;
+        }
+
+        /**
+         * Runs the steps of a stage, adding the time each took to the given field of times if there are any.
+         */
+        static helpers::Steps time(StageTimes* times, Duration StageTimes::* field, helpers::Steps stage) {
+            if (!times) {
+                co_yield std::move(stage);
+                co_return;
+            }
+
+            while (true) {
+                Clock::time_point start = Clock::now();
+                bool more = stage.resume();
+                times->*field += Clock::now() - start;
+
+                if (!more) co_return;
+                co_yield helpers::pause;
+            }
+        }
+    };
+}
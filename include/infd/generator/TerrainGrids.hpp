@@ -0,0 +1,35 @@
+#pragma once
+
+#include <map>
+#include "infd/GLMesh.hpp"
+#include "infd/GLObject.hpp"
+#include "Heightfield.hpp"
+
+namespace infd::generator {
+    /**
+     * The flat grids the terrain of every chunk is drawn with, one per stride, uploaded the first time a stride is
+     * asked for. Chunks only differ by the height texture the vertex shader lifts the grid with, so switching a
+     * chunk's level of detail is just switching grids.
+     *
+     * Must only be used on the main thread.
+     */
+    class TerrainGrids {
+        unsigned int _resolution;
+        std::map<unsigned int, GLMesh> _grids;
+
+    public:
+        explicit TerrainGrids(unsigned int resolution);
+
+        [[nodiscard]] unsigned int resolution() const;
+
+        /**
+         * The grid taking every stride-th vertex of the heightfields, see meshbuilding::generateTerrainGrid.
+         */
+        const GLMesh& get(unsigned int stride);
+
+        /**
+         * Uploads the heights a grid is lifted by for the given heightfield, one texel per sample, border included.
+         */
+        static GLTexture heights(const Heightfield& heightfield);
+    };
+}
@@ -1,5 +0,0 @@
-#pragma once
-
-namespace infd::generator {
-    class Node;
-}
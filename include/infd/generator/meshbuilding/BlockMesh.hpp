@@ -0,0 +1,99 @@
+#pragma once
+
+// std
+#include <vector>
+
+// glm
+#include <glm/geometric.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+// clipper
+#include <clipper2/clipper.h>
+
+// project
+#include <infd/GLMesh.hpp>
+
+// project - generator
+#include <infd/generator/meshbuilding/Polygon.hpp>
+
+
+namespace infd::generator::meshbuilding {
+    /**
+     * A building reduced to its footprint, extruded from the lowest ground under it to its highest roof. Far chunks
+     * draw these in place of the buildings, see FarChunkData.
+     */
+    struct Block {
+        Clipper2Lib::PathD footprint;
+        float base = 0;
+        float top = 0;
+    };
+
+    /**
+     * Merges blocks into a single mesh to be drawn with flat shading. Each is a prism whose walls and roof share one
+     * ring of vertices at the top and one at the bottom, with no floor. The normals only tell flat shading which way
+     * each face looks: bottom vertices point outward, and top ones outward and up.
+     */
+    inline GLMeshBuilder generateBlockMesh(const std::vector<Block>& blocks) {
+        GLMeshBuilder meshBuilder;
+
+        for (const Block& block : blocks) {
+            // Drops points too close together for the triangulation, so the rings are built from what it keeps.
+            Polygon polygon;
+            for (const Clipper2Lib::PointD& point : block.footprint) {
+                glm::vec2 p(point.x, point.y);
+                polygon.addPoint(p);
+            }
+
+            auto n = static_cast<unsigned int>(polygon.points.size());
+            if (n < 3) continue;
+
+            double area = 0;
+            for (unsigned int i = 0, j = n - 1; i < n; j = i++) {
+                area += polygon.points[j].x * polygon.points[i].y - polygon.points[i].x * polygon.points[j].y;
+            }
+            float outwards = area > 0 ? 1.f : -1.f;
+
+            // Mean of the outward normals of the two walls meeting at each point.
+            std::vector<glm::vec3> normals(n);
+            for (unsigned int i = 0; i < n; i++) {
+                const p2t::Point& previous = polygon.points[(i + n - 1) % n];
+                const p2t::Point& current = polygon.points[i];
+                const p2t::Point& next = polygon.points[(i + 1) % n];
+
+                glm::vec2 along = glm::normalize(glm::vec2(current.x - previous.x, current.y - previous.y)) +
+                        glm::normalize(glm::vec2(next.x - current.x, next.y - current.y));
+                normals[i] = glm::vec3(outwards * along.y, 0, -outwards * along.x);
+            }
+
+            // The top ring, then the bottom ring.
+            auto first = static_cast<unsigned int>(meshBuilder.vertices.size());
+            for (bool top : {true, false}) {
+                for (unsigned int i = 0; i < n; i++) {
+                    glm::vec3 normal = normals[i];
+                    if (top) normal.y = glm::length(normal);
+                    // A wall doubling back on itself has no outward, so that point just faces up.
+                    normal = glm::length(normal) > 0 ? glm::normalize(normal) : glm::vec3(0, 1, 0);
+
+                    glm::vec3 position(polygon.points[i].x, top ? block.top : block.base, polygon.points[i].y);
+                    meshBuilder.vertices.push_back({position, normal, glm::vec2(0)});
+                }
+            }
+
+            for (unsigned int i = 0; i < n; i++) {
+                unsigned int j = (i + 1) % n;
+                for (unsigned int index : {i, j + n, j, i, i + n, j + n}) {
+                    meshBuilder.indices.push_back(first + index);
+                }
+            }
+
+            for (const Polygon::Face& face : polygon.triangulate()) {
+                for (unsigned int index : face) {
+                    meshBuilder.indices.push_back(first + index);
+                }
+            }
+        }
+
+        return meshBuilder;
+    }
+}
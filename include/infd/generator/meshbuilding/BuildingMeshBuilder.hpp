@@ -1,59 +1,97 @@
 #pragma once
 
+#include <optional>
 #include "infd/GLMesh.hpp"
 #include "BulletCollision/CollisionShapes/btTriangleMesh.h"
-#include "infd/generator/PerlinNoise.hpp"
+#include "infd/generator/Heightfield.hpp"
 #include "infd/generator/ChunkGenerator.hpp"
+#include "BlockMesh.hpp"
 #include "Polygon.hpp"
+#include "MeshData.hpp"
 
 namespace infd::generator::meshbuilding {
     using namespace Clipper2Lib;
 
+    /**
+     * Footprints are offset and clipped as fixed point Path64s, and only turned back into chunk coordinates to be
+     * meshed. The Clipper2 objects and scratch paths doing so are kept per thread and reused between buildings.
+     * Everything else is built in the memory resource it's given, usually the chunk's Arena.
+     */
     class BuildingMeshBuilder {
-        struct Result {
-            GLMesh mesh;
-            std::unique_ptr<btTriangleMesh> tri_mesh;
+        struct Workspace {
+            ClipperOffset offset;
+            Clipper64 clipper;
+
+            Paths64 subject;
+            Paths64 clip;
+            Paths64 solution;
+            // The last footprint converted back to chunk coordinates.
+            PathD chunkPath;
         };
 
-        float x;
-        float y;
+        helpers::RandomType& random;
 
-        GLMeshBuilder mb;
-        unsigned int index = 0;
+        // Where the mesh and any other scratch space are allocated, until build copies the mesh out.
+        std::pmr::memory_resource* resource;
+        ScratchMesh mesh;
 
-        helpers::RandomType& random;
+        const Heightfield& heightfield;
+        const PathD& originPath;
+
+        Workspace& workspace;
 
-        std::unique_ptr<btTriangleMesh> tri_mesh{new btTriangleMesh()};
+        // Off while only working out the block, in which case hulls just raise top instead of being meshed.
+        bool meshing = true;
+        float top = 0;
 
-        PerlinNoise& noise;
-        PathD originPath;
+        // Fixed point units per chunk, the same precision Clipper2 rounded the old scaled PathDs to.
+        constexpr static const double fixedScale = 1e5;
+        // Tolerance footprints are simplified to after offsetting, in chunks.
+        constexpr static const double simplifyTolerance = 1e-4;
 
-        constexpr static const float scaleFactor = 1000.f;
+        static Workspace& threadWorkspace();
+
+        /**
+         * Builds the pad and the building on it. Returns the building's footprint, empty if the cycle is too small
+         * to build on, and the highest and lowest ground under the pad in heights.
+         */
+        Path64 generate(glm::vec2& heights);
 
         void processHull(PathD& path, float height, float depth);
         void processRoof(PathD& path, float height);
         void processWalls(PathD& path, float height, float depth);
 
         // as known as a "commie block". very simple
-        void generateKhrushchevka(PathD basis, float floorHeight);
+        void generateKhrushchevka(const Path64& basis, float floorHeight);
 
-        void generateSkyscraper(PathD& basis, float floorHeight, float min_radius, PointD& center);
+        void generateSkyscraper(const Path64& basis, float floorHeight, float min_radius, const PointD& center);
 
         glm::vec2 findHeightBounds(PathD& path);
 
-        static PathD unionPath(PathD& a, PathD& b);
+        Path64 unionPath(const Path64& a, const Path64& b);
 
         void drawCollidingTriangle(Triangle &tri);
         void drawTriangle(Triangle &tri);
 
-        static PathD removeVertices(PathD& source, unsigned int count, unsigned int index);
-        static PathD& scalePath(PathD& path, float factor);
-        static PathD shrinkPath(PathD& path, float factor);
-        static auto findRadiusBounds(PathD& path);
+        /**
+         * Converts path into chunk coordinates, in a buffer reused by the next call.
+         */
+        PathD& toChunk(const Path64& path);
+        static Path64 toFixed(const PathD& path);
+
+        Path64 shrinkPath(const Path64& path, double offset);
+        static auto findRadiusBounds(const Path64& path);
 
-        static PathD generatePolygon(float radius, unsigned int sides, const PointD& origin = PointD(0,0));
+        static Path64 generatePolygon(float radius, unsigned int sides, const PointD& origin = PointD(0,0));
     public:
-        BuildingMeshBuilder(ChunkGenerator &generator, PathD& path, helpers::RandomType& random);
-        [[nodiscard]] BuildingMeshBuilder::Result build();
+        BuildingMeshBuilder(ChunkGenerator &generator, PathD& path, helpers::RandomType& random,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+        [[nodiscard]] MeshData build();
+
+        /**
+         * The building as a block, with its footprint simplified to tolerance, in chunks. Makes the same random draws
+         * as build, so the block stands as tall as the building would. Empty if there is no building.
+         */
+        [[nodiscard]] std::optional<Block> block(double tolerance);
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include "infd/GLMesh.hpp"
+#include "BulletCollision/CollisionShapes/btTriangleMesh.h"
+#include "Triangle.hpp"
+
+namespace infd::generator::meshbuilding {
+    /**
+     * CPU side output of a mesh builder. Holds no GL objects, so it can be produced off the main thread and
+     * uploaded later with GLMeshBuilder::build.
+     */
+    struct MeshData {
+        GLMeshBuilder mesh;
+        std::unique_ptr<btTriangleMesh> tri_mesh;
+    };
+
+    /**
+     * Mesh a builder is still adding to, held in scratch memory such as a chunk's Arena. Copied into a MeshData of
+     * exactly the right size once done, rather than growing the output a triangle at a time.
+     */
+    struct ScratchMesh {
+        std::pmr::vector<MeshVertex> vertices;
+        std::pmr::vector<unsigned int> indices;
+        unsigned int index = 0;
+        // Triangles of the mesh that also go in the collision mesh, in the order they were added.
+        std::pmr::vector<Triangle> collision;
+
+        // Allocator aware, so a std::pmr::vector of them puts them all in its own memory resource.
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+
+        explicit ScratchMesh(const allocator_type& allocator = {}) :
+            vertices(allocator), indices(allocator), collision(allocator) {}
+
+        /**
+         * Makes room for triangles more triangles, colliding of which also collide. Grows geometrically, so it can be
+         * called for every part of a mesh as it's added.
+         */
+        void reserve(size_t triangles, size_t colliding) {
+            grow(vertices, 3 * triangles);
+            grow(indices, 3 * triangles);
+            grow(collision, colliding);
+        }
+
+        void draw(const Triangle& triangle) {
+            triangle.addToMesh(*this, index);
+        }
+
+        void drawColliding(const Triangle& triangle) {
+            triangle.addToMesh(*this, index);
+            collision.push_back(triangle);
+        }
+
+        /**
+         * Appends the mesh to out, which should have room for it already.
+         */
+        void appendTo(MeshData& out) const {
+            auto offset = static_cast<unsigned int>(out.mesh.vertices.size());
+
+            out.mesh.vertices.insert(out.mesh.vertices.end(), vertices.begin(), vertices.end());
+            for (unsigned int i : indices) {
+                out.mesh.indices.push_back(offset + i);
+            }
+            for (const Triangle& triangle : collision) {
+                triangle.addToCollision(*out.tri_mesh);
+            }
+        }
+
+        /**
+         * An empty MeshData with exactly enough room for the given totals of vertices, indices and colliding triangles.
+         */
+        static MeshData allocate(size_t vertexCount, size_t indexCount, size_t collisionCount) {
+            MeshData data{GLMeshBuilder(), std::make_unique<btTriangleMesh>()};
+            data.mesh.vertices.reserve(vertexCount);
+            data.mesh.indices.reserve(indexCount);
+            data.tri_mesh->preallocateVertices(static_cast<int>(3 * collisionCount));
+            data.tri_mesh->preallocateIndices(static_cast<int>(3 * collisionCount));
+            return data;
+        }
+
+        /**
+         * A copy of the mesh, sized exactly.
+         */
+        [[nodiscard]] MeshData data() const {
+            MeshData out = allocate(vertices.size(), indices.size(), collision.size());
+            appendTo(out);
+            return out;
+        }
+
+    private:
+        template <typename T>
+        static void grow(std::pmr::vector<T>& values, size_t count) {
+            if (values.size() + count > values.capacity()) {
+                values.reserve(std::max(values.size() + count, 2 * values.capacity()));
+            }
+        }
+    };
+}
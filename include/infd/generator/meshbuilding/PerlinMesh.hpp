@@ -1,11 +1,14 @@
 #pragma once
 
 // std
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <memory>
-#include <vector>
 
 // glm
-#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
 // bullet
@@ -16,8 +19,7 @@
 
 // project - generator
 #include <infd/generator/ChunkGenerator.hpp>
-#include <infd/generator/PerlinNoise.hpp>
-#include <infd/generator/meshbuilding/Triangle.hpp>
+#include <infd/generator/Heightfield.hpp>
 
 // project - math
 #include <infd/math/glm_bullet.hpp>
@@ -25,61 +27,170 @@
 
 namespace infd::generator::meshbuilding {
     /**
-     * Constructs a unit mesh based off the values from the given perlin noise
+     * How far the skirts must hang below the chunk edges to cover the gap to a neighbour meshed at any of the
+     * TERRAIN_LOD_STRIDES, i.e. the widest gap between the approximations of an edge at any two of them. The strides
+     * don't all divide one another, so every pair is measured rather than just each against the coarsest.
      */
-    inline auto generatePerlinMesh(int offsetX, int offsetY, PerlinNoise& noise, unsigned int subdivisions = 20) {
+    inline float terrainSkirtDepth(const Heightfield& heightfield) {
+        int resolution = static_cast<int>(heightfield.resolution());
+
+        // Height at vertex i of an edge meshed from every stride-th vertex.
+        auto approximate = [resolution](auto height, int stride, int i) {
+            int start = std::min(i - i % stride, resolution - stride);
+            float t = static_cast<float>(i - start) / static_cast<float>(stride);
+            return glm::mix(height(start), height(start + stride), t);
+        };
+
+        float depth = 0;
+        for (int edge : {0, resolution}) {
+            auto alongX = [&](int i) { return heightfield.vertex(i, edge); };
+            auto alongY = [&](int i) { return heightfield.vertex(edge, i); };
+
+            for (unsigned int fine : TERRAIN_LOD_STRIDES) {
+                for (unsigned int coarse : TERRAIN_LOD_STRIDES) {
+                    if (fine >= coarse) continue;
+                    int a = static_cast<int>(fine);
+                    int b = static_cast<int>(coarse);
+
+                    // Both are straight between whole vertices, so the gap is widest at one of them.
+                    for (int i = 0; i <= resolution; i++) {
+                        float xGap = approximate(alongX, a, i) - approximate(alongX, b, i);
+                        float yGap = approximate(alongY, a, i) - approximate(alongY, b, i);
+                        depth = std::max({depth, std::abs(xGap), std::abs(yGap)});
+                    }
+                }
+            }
+        }
+
+        return depth + TERRAIN_SKIRT_MARGIN;
+    }
+
+    /**
+     * Constructs the flat grid every chunk's terrain is drawn with, from every stride-th vertex of a heightfield of the
+     * given resolution. It spans the chunk at height 0, and the vertex shader lifts it by the chunk's heights: each
+     * vertex's texture coordinates hold the heightfield vertex (i, j) it stands for. Surface vertices point up, and are
+     * given the heightfield's normals in the shader too.
+     *
+     * Each edge gets a skirt, whose vertices keep their horizontal outward normals and are lowered by the chunk's
+     * terrainSkirtDepth(), so no cracks show where a neighbour uses a different stride.
+     */
+    inline GLMeshBuilder generateTerrainGrid(unsigned int resolution, unsigned int stride = 1) {
         GLMeshBuilder meshBuilder;
 
+        int step = static_cast<int>(stride);
+        int subdivisions = static_cast<int>(resolution) / step;
+        int gridSize = subdivisions + 1;
         float subdivisionSize = 1.f/static_cast<float>(subdivisions);
 
-        unsigned int index = 0;
+        meshBuilder.vertices.reserve(gridSize * gridSize + 4 * gridSize);
+        meshBuilder.indices.reserve(subdivisions * subdivisions * 6 + 4 * subdivisions * 6);
 
-        std::unique_ptr<btTriangleMesh> tri_mesh{new btTriangleMesh()};
+        // Vertex (x, y) lives at index x * gridSize + y.
+        for (int x = 0; x < gridSize; x++) {
+            for (int y = 0; y < gridSize; y++) {
+                glm::vec3 position(x * subdivisionSize, 0, y * subdivisionSize);
+                meshBuilder.vertices.push_back({position, glm::vec3(0, 1, 0), glm::vec2(x * step, y * step)});
+            }
+        }
 
-        for (unsigned int x = 0; x < subdivisions; x++) {
-            for (unsigned int y = 0; y < subdivisions; y++) {
-                float relX = x * subdivisionSize;
-                float relY = y * subdivisionSize;
-                float noiseX = relX + offsetX;
-                float noiseY = relY + offsetY;
-
-                glm::vec3 xy1 = glm::vec3(
-                        relX,
-                        PERLIN_TERRAIN_FACTOR * ChunkGenerator::scaledPerlin(noiseX, noiseY, noise),
-                        relY
-                );
-                glm::vec3 xy2 = glm::vec3(
-                        relX+subdivisionSize,
-                        PERLIN_TERRAIN_FACTOR * ChunkGenerator::scaledPerlin(noiseX+subdivisionSize, noiseY, noise),
-                        relY
-                );
-                glm::vec3 xy3 = glm::vec3(
-                        relX,
-                        PERLIN_TERRAIN_FACTOR * ChunkGenerator::scaledPerlin(noiseX, noiseY+subdivisionSize, noise),
-                        relY+subdivisionSize
-                );
-                glm::vec3 xy4 = glm::vec3(
-                        relX+subdivisionSize,
-                        PERLIN_TERRAIN_FACTOR * ChunkGenerator::scaledPerlin(noiseX+subdivisionSize, noiseY+subdivisionSize, noise),
-                        relY+subdivisionSize
-                );
-
-                Triangle t1(xy3, xy2, xy1);
-                Triangle t2(xy2, xy3, xy4);
-
-                t1.addToMesh(meshBuilder, index);
-                t2.addToMesh(meshBuilder, index);
-
-                t1.addToCollision(*tri_mesh);
-                t2.addToCollision(*tri_mesh);
+        for (int x = 0; x < subdivisions; x++) {
+            for (int y = 0; y < subdivisions; y++) {
+                unsigned int xy1 = x * gridSize + y;
+                unsigned int xy2 = xy1 + gridSize;
+                unsigned int xy3 = xy1 + 1;
+                unsigned int xy4 = xy2 + 1;
+
+                // Same split and winding as a Triangle(xy3, xy2, xy1) and Triangle(xy2, xy3, xy4) pair.
+                for (unsigned int i : {xy3, xy2, xy1, xy2, xy3, xy4}) {
+                    meshBuilder.indices.push_back(i);
+                }
             }
         }
 
-        struct Result {
-            GLMesh mesh;
-            std::unique_ptr<btTriangleMesh> tri_mesh;
+        struct Edge {
+            unsigned int first;
+            unsigned int increment;
+            glm::vec3 outward;
         };
 
-        return Result{meshBuilder.build(), std::move(tri_mesh)};
+        for (const Edge& edge : {
+                Edge{0, 1, glm::vec3(-1, 0, 0)},
+                Edge{static_cast<unsigned int>(subdivisions * gridSize), 1, glm::vec3(1, 0, 0)},
+                Edge{0, static_cast<unsigned int>(gridSize), glm::vec3(0, 0, -1)},
+                Edge{static_cast<unsigned int>(subdivisions), static_cast<unsigned int>(gridSize), glm::vec3(0, 0, 1)},
+        }) {
+            auto lowered = static_cast<unsigned int>(meshBuilder.vertices.size());
+
+            for (int i = 0; i < gridSize; i++) {
+                const MeshVertex& top = meshBuilder.vertices[edge.first + i * edge.increment];
+                meshBuilder.vertices.push_back({top.pos, edge.outward, top.uv});
+            }
+
+            for (unsigned int i = 0; i < static_cast<unsigned int>(subdivisions); i++) {
+                unsigned int top = edge.first + i * edge.increment;
+                unsigned int nextTop = top + edge.increment;
+
+                for (unsigned int index : {top, lowered + i, nextTop, nextTop, lowered + i, lowered + i + 1}) {
+                    meshBuilder.indices.push_back(index);
+                }
+            }
+        }
+
+        return meshBuilder;
+    }
+
+    /**
+     * Lifts a grid from generateTerrainGrid() by the given heightfield on the CPU, as the vertex shaders do with a
+     * height texture, for terrain merged into a mesh drawn without one. Skirts are lowered by skirtDepth, surface
+     * vertices take the heightfield's normals, and every texture coordinate is cleared once read.
+     */
+    inline void displaceTerrainGrid(GLMeshBuilder& grid, const Heightfield& heightfield, float skirtDepth) {
+        for (MeshVertex& vertex : grid.vertices) {
+            glm::ivec2 index(vertex.uv);
+            vertex.pos.y = heightfield.vertex(index.x, index.y);
+
+            if (vertex.norm.y == 0) {
+                vertex.pos.y -= skirtDepth;
+            } else {
+                vertex.norm = heightfield.normal(index.x, index.y);
+            }
+            vertex.uv = glm::vec2(0);
+        }
+    }
+
+    /**
+     * Constructs the collision mesh of a chunk from every grid vertex of the given heightfield, sharing vertices
+     * between cells. Always at full resolution, whatever the render stride.
+     */
+    inline std::unique_ptr<btTriangleMesh> generateTerrainCollision(const Heightfield& heightfield) {
+        int subdivisions = static_cast<int>(heightfield.resolution());
+        int gridSize = subdivisions + 1;
+        float subdivisionSize = 1.f/static_cast<float>(subdivisions);
+
+        std::unique_ptr<btTriangleMesh> tri_mesh{new btTriangleMesh()};
+
+        tri_mesh->preallocateVertices(gridSize * gridSize);
+        tri_mesh->preallocateIndices(subdivisions * subdivisions * 6);
+
+        for (int x = 0; x < gridSize; x++) {
+            for (int y = 0; y < gridSize; y++) {
+                glm::vec3 position(x * subdivisionSize, heightfield.vertex(x, y), y * subdivisionSize);
+                tri_mesh->findOrAddVertex(math::toBullet(position), false);
+            }
+        }
+
+        for (int x = 0; x < subdivisions; x++) {
+            for (int y = 0; y < subdivisions; y++) {
+                int xy1 = x * gridSize + y;
+                int xy2 = xy1 + gridSize;
+                int xy3 = xy1 + 1;
+                int xy4 = xy2 + 1;
+
+                tri_mesh->addTriangleIndices(xy3, xy2, xy1);
+                tri_mesh->addTriangleIndices(xy2, xy3, xy4);
+            }
+        }
+
+        return tri_mesh;
     }
 }
@@ -1,17 +1,73 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include "poly2tri/poly2tri.h"
 #include "glm/vec2.hpp"
 #include "Triangle.hpp"
 
 namespace infd::generator::meshbuilding {
+    /**
+     * Simple polygon, triangulated by the cheapest method that handles it. Convex polygons are fanned and other small
+     * ones ear clipped, without allocating beyond the output. Anything larger, or anything the ear clipper gives up
+     * on, goes through poly2tri's constrained Delaunay triangulation.
+     *
+     * The points and faces are allocated from the memory resource it's constructed with, a chunk's Arena while
+     * meshing one. poly2tri still allocates for itself.
+     */
     class Polygon {
-        std::unique_ptr<p2t::CDT> polygon = nullptr;
     public:
-        std::vector<p2t::Point> points;
+        // Indices into points, wound the same way as poly2tri's triangles.
+        using Face = std::array<unsigned int, 3>;
+
+        enum class Method {
+            None,
+            Fan,
+            EarClipping,
+            Cdt
+        };
+
+        // Most points the ear clipper takes. Ear clipping is quadratic, so past this the CDT wins.
+        static const unsigned int MAX_EAR_CLIPPING_POINTS = 32;
+
+    private:
+        std::pmr::vector<Face> _faces;
+        Method _method = Method::None;
+
+        bool triangulateFan(bool ccw);
+        bool triangulateEars(bool ccw);
+
+    public:
+        std::pmr::vector<p2t::Point> points;
+
+        explicit Polygon(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        /**
+         * Makes room for count points, and the faces triangulating them.
+         */
+        void reserve(size_t count);
         void addPoint(glm::vec2& point);
-        std::vector<p2t::Triangle*> triangulate();
+
+        /**
+         * Triangulates points, which must not be changed while the result is in use.
+         */
+        const std::pmr::vector<Face>& triangulate();
+
+        /**
+         * Always uses poly2tri, as everything too complex for the fast paths does.
+         */
+        const std::pmr::vector<Face>& triangulateCdt();
+
+        /**
+         * Which method the last triangulation used.
+         */
+        [[nodiscard]] Method method() const;
+
+        /**
+         * The triangle of face, in the winding and layout of Triangle::convertTo.
+         */
+        [[nodiscard]] Triangle convert(const Face& face, glm::vec3 yValues = glm::vec3(0), glm::vec2 pos = glm::vec2(0)) const;
     };
 }
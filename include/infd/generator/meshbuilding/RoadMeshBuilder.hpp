@@ -1,50 +1,55 @@
 #pragma once
 
-#include <infd/generator/Node.hpp>
+#include <infd/generator/RoadGraph.hpp>
 #include "infd/GLMesh.hpp"
-#include "infd/generator/PerlinNoise.hpp"
+#include "infd/generator/Heightfield.hpp"
 #include "infd/generator/ChunkGenerator.hpp"
 #include "Polygon.hpp"
+#include "Triangle.hpp"
+#include "MeshData.hpp"
 
 namespace infd::generator::meshbuilding {
     class RoadMeshBuilder {
-        struct Result {
-            GLMesh mesh;
-            std::unique_ptr<btTriangleMesh> tri_mesh;
-        };
-
         struct Offset {
             glm::vec2 cull;
             float tangent;
             float midAngle;
         };
 
-        float x;
-        float y;
-
-        GLMeshBuilder mb;
-        unsigned int index = 0;
-        std::unique_ptr<btTriangleMesh> tri_mesh{new btTriangleMesh()};
-
-        PerlinNoise& noise;
-        std::vector<std::shared_ptr<Node>>& nodes;
+        const Heightfield& heightfield;
+        RoadGraph& graph;
 
-        void generateNode(Node& node);
-        void generateIntersection(Node& node);
-        void generateSegment(Edge& edge, float offset);
-        void processTriangle(Triangle& triangle);
-        void processIntersectionWall(p2t::Point& a, p2t::Point& b, float height, Node& node);
+        // Where each node's geometry is built before being stitched together, and any scratch space on the way.
+        std::pmr::memory_resource* resource;
 
-        void drawTriangle(Triangle& tri);
-        void drawCollidingTriangle(Triangle& tri);
+        // Each node is meshed independently of every other node and stitched together afterwards.
+        void generateNode(NodeIndex node, ScratchMesh& out);
+        void generateIntersection(NodeIndex node, ScratchMesh& out);
+        void generateSegment(EdgeIndex edge, float offset, ScratchMesh& out);
+        void processIntersectionWall(p2t::Point& a, p2t::Point& b, float height, NodeIndex node, ScratchMesh& out);
 
-        static void emplaceOffset(Edge& a, Edge& b, float angle, std::vector<Offset>& offsets);
-        static void emplaceVertex(Offset& a, Offset& b, Edge& edge, Polygon& output);
+        static void emplaceOffset(float basisAngle, float angle, std::pmr::vector<Offset>& offsets);
+        static void emplaceVertex(Offset& a, Offset& b, float edgeAngle, Polygon& output);
         static float calculateTangent(float angle);
         static glm::vec2 calculateIntersection(float basisAngle, float halfAngle, bool flipAxis = false);
 
     public:
-        RoadMeshBuilder(ChunkGenerator& generator);
-        [[nodiscard]] RoadMeshBuilder::Result build();
+        /**
+         * Builds the meshes of each node in resource, usually the chunk's Arena, before joining them into the output.
+         */
+        explicit RoadMeshBuilder(ChunkGenerator& generator,
+                                 std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        /**
+         * Meshes every node in parallel, then joins them in node order, so the result is the same for any number
+         * of threads.
+         */
+        [[nodiscard]] MeshData build();
+
+        /**
+         * Builds into out a step at a time, meshing batch nodes per step. The builder and generator must outlive the
+         * steps.
+         */
+        helpers::Steps build(MeshData& out, size_t batch);
     };
 }
@@ -15,12 +15,27 @@ namespace infd::generator::meshbuilding {
 
         Triangle(glm::vec3 a, glm::vec3 b, glm::vec3 c);
 
-        static Triangle convertTo(p2t::Triangle& tri, glm::vec3 yValues = glm::vec3(0), glm::vec2 pos = glm::vec2(0));
+        static Triangle convertTo(const p2t::Point& p0, const p2t::Point& p1, const p2t::Point& p2, glm::vec3 yValues = glm::vec3(0), glm::vec2 pos = glm::vec2(0));
 
-        void addToMesh(GLMeshBuilder& mb, unsigned int& index);
-        void addToCollision(btTriangleMesh& tri_mesh);
+        /**
+         * Adds the triangle to anything with GLMeshBuilder's vertices and indices.
+         */
+        template <typename Mesh>
+        void addToMesh(Mesh& mb, unsigned int& index) const;
+        void addToCollision(btTriangleMesh& tri_mesh) const;
     };
 
+    template <typename Mesh>
+    void Triangle::addToMesh(Mesh& mb, unsigned int& index) const {
+        mb.vertices.emplace_back(a, norm);
+        mb.vertices.emplace_back(b, norm);
+        mb.vertices.emplace_back(c, norm);
+
+        mb.indices.push_back(index++);
+        mb.indices.push_back(index++);
+        mb.indices.push_back(index++);
+    }
+
     /**
      * Build and processes a simple quad. Points are assumed to be ordered ccw
      */
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+namespace infd::generator::helpers {
+    /**
+     * PCG32 (XSH RR) random generator, after <a href="https://www.pcg-random.org">O'Neill</a>.
+     *
+     * A 64 bit LCG whose output is permuted down to 32 bits. Its whole state is 16 bytes, so it's as cheap to create
+     * and copy as an int pair, and every stream number picks an independent sequence for the same seed. It meets
+     * UniformRandomBitGenerator, but the draws below are defined here rather than by the standard library's
+     * distributions, so generation comes out the same on every platform.
+     */
+    class Pcg32 {
+        std::uint64_t _state = 0;
+        std::uint64_t _increment;
+
+    public:
+        using result_type = std::uint32_t;
+
+        explicit Pcg32(std::uint64_t seed = 0, std::uint64_t stream = 0) : _increment((stream << 1u) | 1u) {
+            (*this)();
+            _state += seed;
+            (*this)();
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return UINT32_MAX; }
+
+        result_type operator()() {
+            std::uint64_t state = _state;
+            _state = state * 6364136223846793005ull + _increment;
+
+            auto xorShifted = static_cast<std::uint32_t>(((state >> 18u) ^ state) >> 27u);
+            auto rotation = static_cast<std::uint32_t>(state >> 59u);
+            return (xorShifted >> rotation) | (xorShifted << ((-rotation) & 31u));
+        }
+
+        /**
+         * Uniform in [0, bound), without modulo bias.
+         */
+        std::uint32_t bounded(std::uint32_t bound) {
+            std::uint32_t threshold = -bound % bound;
+            while (true) {
+                std::uint32_t value = (*this)();
+                if (value >= threshold) return value % bound;
+            }
+        }
+
+        /**
+         * Uniform in [0, 1), from the top 24 bits so every value is exact.
+         */
+        float uniform() {
+            return static_cast<float>((*this)() >> 8u) * (1.f / 16777216.f);
+        }
+
+        /**
+         * Uniform in [min, max).
+         */
+        float uniform(float min, float max) {
+            return min + (max - min) * uniform();
+        }
+
+        /**
+         * Uniform in [min, max], both inclusive.
+         */
+        int uniformInt(int min, int max) {
+            return min + static_cast<int>(bounded(static_cast<std::uint32_t>(max - min) + 1u));
+        }
+    };
+}
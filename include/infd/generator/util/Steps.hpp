@@ -0,0 +1,103 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace infd::generator::helpers {
+    // What a Steps coroutine yields between steps, with co_yield helpers::pause.
+    struct Pause {};
+    inline constexpr Pause pause{};
+
+    // Passed to a constructor to leave the work to the object's generate(), which returns the Steps doing it.
+    struct Deferred {};
+    inline constexpr Deferred deferred{};
+
+    /**
+     * Coroutine doing some long piece of work a step at a time, pausing with co_yield pause between steps. Nothing
+     * runs until the first resume, and the state it pauses with stays valid however long it waits for the next.
+     * Yielding another Steps runs all of its steps, as steps of this one, before carrying on.
+     *
+     * Owns the coroutine, so destroying a Steps part way through abandons the work and frees that state. Anything
+     * the coroutine refers to has to outlive it, the object a member coroutine was called on included.
+     */
+    class Steps {
+    public:
+        struct promise_type {
+            std::exception_ptr exception;
+            // The Steps it yielded and is waiting on, if any.
+            Steps* delegate = nullptr;
+
+            Steps get_return_object() { return Steps(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            std::suspend_always yield_value(Pause) noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+            // The awaiter holds on to the yielded Steps in the coroutine's frame until it carries on.
+            auto yield_value(Steps steps) noexcept {
+                struct Awaiter {
+                    Steps steps;
+
+                    bool await_ready() const noexcept { return steps.done(); }
+                    void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                        handle.promise().delegate = &steps;
+                    }
+                    void await_resume() const noexcept {}
+                };
+                return Awaiter{std::move(steps)};
+            }
+        };
+
+    private:
+        std::coroutine_handle<promise_type> _handle;
+
+        explicit Steps(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+    public:
+        // No work, already done.
+        Steps() = default;
+        Steps(Steps&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+        Steps& operator=(Steps other) noexcept {
+            std::swap(_handle, other._handle);
+            return *this;
+        }
+        ~Steps() {
+            if (_handle) _handle.destroy();
+        }
+
+        [[nodiscard]] bool done() const { return !_handle || _handle.done(); }
+
+        /**
+         * Runs the next step. Returns whether there are any left. Rethrows anything the step threw, after which there
+         * are none.
+         */
+        bool resume() {
+            if (done()) return false;
+
+            promise_type& promise = _handle.promise();
+            if (promise.delegate) {
+                try {
+                    if (promise.delegate->resume()) return true;
+                } catch (...) {
+                    _handle.destroy();
+                    _handle = nullptr;
+                    throw;
+                }
+                promise.delegate = nullptr;
+            }
+
+            _handle.resume();
+            if (promise.exception) std::rethrow_exception(std::exchange(promise.exception, nullptr));
+            return !_handle.done();
+        }
+
+        /**
+         * Runs every step left.
+         */
+        void run() {
+            while (resume()) {}
+        }
+    };
+}
@@ -1,12 +1,23 @@
 #pragma once
 
+#include <cstdint>
+#include <iterator>
+#include <utility>
 #include <vector>
-#include <random>
 #include <stdexcept>
+#include "Pcg32.hpp"
 
 namespace infd::generator::helpers {
     // Alias to allow for replacement if required for performance reasons
-    using RandomType = std::mt19937;
+    using RandomType = Pcg32;
+
+    /**
+     * What a random stream drawn for a chunk is used for, so that streams for different things never overlap.
+     */
+    enum class Stream : std::uint32_t {
+        Node,
+        Building
+    };
 
     /**
      * Produces a hash for a given unsigned int.
@@ -50,12 +61,30 @@ namespace infd::generator::helpers {
     }
 
     /**
-     * Generates a random padded distribution of points between 0 and 1;
+     * Generator for the index-th item of the given kind in the chunk at (x, y), e.g. one of its buildings. Every item
+     * gets a stream of its own, so items can be generated independently and in any order.
      */
-    template <class T, class Generator>
-    std::vector<T> paddedDistribution(size_t count, T radius, T edgePadding, Generator &random) {
-        std::uniform_real_distribution<T> dist(0, 1);
+    inline RandomType itemRandom(int x, int y, unsigned int seed, Stream kind, std::uint32_t index) {
+        std::uint64_t stream = (static_cast<std::uint64_t>(kind) << 32u) | index;
+        return RandomType(skeetoHash(szudsikSignedCombinator(x, y) + seed), stream);
+    }
 
+    /**
+     * Fisher-Yates shuffle. Unlike std::shuffle, the result doesn't depend on the standard library.
+     */
+    template <class Iterator>
+    void shuffle(Iterator begin, Iterator end, RandomType& random) {
+        auto count = static_cast<std::uint32_t>(std::distance(begin, end));
+        for (std::uint32_t i = count; i > 1; i--) {
+            std::swap(begin[i - 1], begin[random.bounded(i)]);
+        }
+    }
+
+    /**
+     * Generates a random padded distribution of points between 0 and 1;
+     */
+    template <class T>
+    std::vector<T> paddedDistribution(size_t count, T radius, T edgePadding, RandomType &random) {
         T padding = 2*(radius*count + edgePadding);
 
         if (padding > 1) throw std::runtime_error("Not enough space for random distribution.");
@@ -64,7 +93,7 @@ namespace infd::generator::helpers {
         values.reserve(count);
 
         for (unsigned int i = 0; i < count; i++) {
-            values.push_back(dist(random) * (1 - padding) + radius + edgePadding + (2 * radius * i));
+            values.push_back(static_cast<T>(random.uniform()) * (1 - padding) + radius + edgePadding + (2 * radius * i));
         }
 
         return values;
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <vector>
+
+#ifdef CGRA_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+namespace infd::generator::helpers {
+    /**
+     * Calls fn(i) for every i in [0, count), shared between OpenMP threads when built with OpenMP and serially
+     * otherwise. Each call should only write to the state of its own item.
+     *
+     * Exceptions are caught per item and the one from the lowest index is rethrown after every call has finished,
+     * so even failures don't depend on how the items were split between threads.
+     */
+    template <typename Fn>
+    void parallelFor(size_t count, Fn&& fn) {
+        std::vector<std::exception_ptr> errors(count);
+
+#ifdef CGRA_HAVE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(count); i++) {
+            try {
+                fn(static_cast<size_t>(i));
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+
+        for (std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * Most threads parallelFor would use if called from this thread.
+     */
+    inline size_t threadCount() {
+#ifdef CGRA_HAVE_OPENMP
+        return static_cast<size_t>(omp_get_max_threads());
+#else
+        return 1;
+#endif
+    }
+
+    /**
+     * Index of the calling thread within the parallelFor running it, from 0 to below threadCount(). 0 outside one.
+     */
+    inline size_t threadIndex() {
+#ifdef CGRA_HAVE_OPENMP
+        return static_cast<size_t>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * Caps the threads parallelFor may use when called from this thread. Has no effect without OpenMP.
+     */
+    inline void parallelThreads(unsigned int threads) {
+#ifdef CGRA_HAVE_OPENMP
+        omp_set_num_threads(static_cast<int>(threads));
+#else
+        (void)threads;
+#endif
+    }
+}
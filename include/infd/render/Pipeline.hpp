@@ -25,8 +25,25 @@ namespace infd::render {
     struct RenderSettings;
 
     class Pipeline {
+        // locations of the uniforms sent for every item drawn, looked up once per shader rather than per draw
+        struct ItemUniforms {
+            GLint model_matrix = -1;
+            GLint displaced = -1;
+            GLint skirt_depth = -1;
+            GLint colour = -1;
+            GLint two_tone = -1;
+            GLint secondary_colour = -1;
+            GLint shininess = -1;
+            GLint flat_shading = -1;
+
+            ItemUniforms() = default;
+            explicit ItemUniforms(const GLProgram& shader);
+        };
+
         GLProgram _main_shader;
+        ItemUniforms _main_uniforms;
         GLProgram _shadow_shader;
+        ItemUniforms _shadow_uniforms;
         GLProgram _dither_shader;
         GLProgram _blit_shader;
         GLProgram _threshold_blit_shader;
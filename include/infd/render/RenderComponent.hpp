@@ -5,6 +5,9 @@
 #include "fwd/Renderer.hpp"
 #include "Renderer.hpp"
 #include "infd/GLMesh.hpp"
+#include "infd/GLObject.hpp"
+
+#include <optional>
 
 namespace infd::render {
     class RenderComponent : public scene::Component {
@@ -16,10 +19,32 @@ namespace infd::render {
 
         struct {
             glm::vec3 colour {1, 0, 1};
+            // when set, vertices with a texture coordinate u of 1 take this colour instead, so two surfaces of
+            // different colours can share one mesh and one draw (see generator::FarChunkData)
+            std::optional<glm::vec3> secondary_colour;
             float shininess = 20;
+            // light each triangle with its face normal instead of the interpolated vertex normals
+            bool flat_shading = false;
+            // left out of the shadow map, e.g. for anything too far away to land in it
+            bool casts_shadows = true;
         } material;
+
+        // when heights is set, the mesh is a flat grid that the vertex shaders lift by it, as for terrain (see
+        // generator::TerrainGrids). heights is an R32F texture with one texel per grid vertex plus a ring around them,
+        // laid out like generator::Heightfield::samples(). vertices with a horizontal normal are skirts, and are
+        // lowered by skirt_depth
+        struct {
+            std::optional<GLTexture> heights;
+            float skirt_depth = 0;
+        } displacement;
+
+        [[nodiscard]] bool visible() const;
+        // hidden components are taken out of the renderer's list entirely, rather than skipped every frame
+        void visible(bool value);
+
       private:
-        const RenderComponentHandler _hook;
+        Renderer& _renderer;
+        RenderComponentHandler _hook;
     };
 
     /*
@@ -53,6 +78,7 @@ namespace infd::render {
      * Renderer throws if it tries to render without a camera
      *
      * fov is the field of view in radians
+     * far_plane is the distance past which nothing is drawn, and the near plane follows it (see nearPlane())
      * forward() returns a vector pointing the direction the camera is facing
      * view() and proj() return the camera and (perspective) projection matrices
      *
@@ -64,7 +90,14 @@ namespace infd::render {
     class CameraComponent : public scene::Component {
       public:
         float fov = 1;
+        float far_plane = 1000;
+
+        // the near plane sits at far_plane / max_depth_ratio but never closer than min_near_plane, so pushing the far
+        // plane out to the horizon doesn't thin out the depth buffer's precision
+        static constexpr float min_near_plane = 0.1f;
+        static constexpr float max_depth_ratio = 10000;
 
+        [[nodiscard]] float nearPlane() const;
         [[nodiscard]] glm::vec3 forward() const;
         [[nodiscard]] glm::mat4 view() const;
         [[nodiscard]] glm::mat4 proj(glm::vec2 window_size) const;
@@ -12,27 +12,52 @@
 namespace infd::render {
     GLMesh build_fullscreen_texture_mesh();
 
+    // by location, for uniforms sent often enough to look up once, see Pipeline::ItemUniforms
+    inline void sendUniform(GLint location, float value) {
+        glUniform1f(location, value);
+    }
+
+    inline void sendUniform(GLint location, int value) {
+        glUniform1i(location, value);
+    }
+
+    inline void sendUniform(GLint location, glm::vec2 value) {
+        glUniform2fv(location, 1, glm::value_ptr(value));
+    }
+
+    inline void sendUniform(GLint location, glm::ivec2 value) {
+        glUniform2iv(location, 1, glm::value_ptr(value));
+    }
+
+    inline void sendUniform(GLint location, glm::vec3 value) {
+        glUniform3fv(location, 1, glm::value_ptr(value));
+    }
+
+    inline void sendUniform(GLint location, glm::mat4 value) {
+        glUniformMatrix4fv(location, 1, false, value_ptr(value));
+    }
+
     inline void sendUniform(const GLProgram& shader, const std::string& name, float value) {
-        glUniform1f(glGetUniformLocation(shader, name.c_str()), value);
+        sendUniform(glGetUniformLocation(shader, name.c_str()), value);
     }
 
     inline void sendUniform(const GLProgram& shader, const std::string& name, int value) {
-        glUniform1i(glGetUniformLocation(shader, name.c_str()), value);
+        sendUniform(glGetUniformLocation(shader, name.c_str()), value);
     }
 
     inline void sendUniform(const GLProgram& shader, const std::string& name, glm::vec2 value) {
-        glUniform2fv(glGetUniformLocation(shader, name.c_str()), 1, glm::value_ptr(value));
+        sendUniform(glGetUniformLocation(shader, name.c_str()), value);
     }
 
     inline void sendUniform(const GLProgram& shader, const std::string& name, glm::ivec2 value) {
-        glUniform2iv(glGetUniformLocation(shader, name.c_str()), 1, glm::value_ptr(value));
+        sendUniform(glGetUniformLocation(shader, name.c_str()), value);
     }
 
     inline void sendUniform(const GLProgram& shader, const std::string& name, glm::vec3 value) {
-        glUniform3fv(glGetUniformLocation(shader, name.c_str()), 1, glm::value_ptr(value));
+        sendUniform(glGetUniformLocation(shader, name.c_str()), value);
     }
 
     inline void sendUniform(const GLProgram& shader, const std::string& name, glm::mat4 value) {
-        glUniformMatrix4fv(glGetUniformLocation(shader, name.c_str()), 1, false, value_ptr(value));
+        sendUniform(glGetUniformLocation(shader, name.c_str()), value);
     }
 }
@@ -9,6 +9,9 @@
 #include <BulletCollision/CollisionShapes/btCollisionShape.h>
 #include <BulletCollision/CollisionShapes/btTriangleMesh.h>
 #include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
+#include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btStridingMeshInterface.h>
 
 // project - scene::physics
 #include <infd/scene/physics/physics.hpp>
@@ -16,30 +19,55 @@
 
 namespace infd::scene::physics {
 
+	/*
+	 * The BVH is built once over the unscaled mesh and scaling is applied through btScaledBvhTriangleMeshShape,
+	 * since scaling a btBvhTriangleMeshShape directly rebuilds its whole BVH.
+	 */
 	class BvhTriangleMeshShape : public CollisionShape {
-		std::unique_ptr<btTriangleMesh> _triangle_mesh;
+		// keeps alive whatever the mesh and a prebuilt BVH point into, e.g. a mapped chunk file
+		std::shared_ptr<const void> _storage;
+		std::unique_ptr<btStridingMeshInterface> _triangle_mesh;
 		btBvhTriangleMeshShape _triangle_mesh_shape;
+		btScaledBvhTriangleMeshShape _scaled_shape;
 
 		btCollisionShape& getBtCollisionShape() noexcept override {
-			return _triangle_mesh_shape;
+			return _scaled_shape;
 		}
 
 		const btCollisionShape& getBtCollisionShape() const noexcept override {
-			return _triangle_mesh_shape;
+			return _scaled_shape;
 		}
 
 		void syncCollisionShapeScaling() override {
-			_triangle_mesh_shape.setLocalScaling(
+			_scaled_shape.setLocalScaling(
 				math::toBullet(transform().localScale())
 			);
 		}
 
 	public:
-		[[nodiscard]] BvhTriangleMeshShape(std::unique_ptr<btTriangleMesh> triangle_mesh) noexcept :
+		[[nodiscard]] BvhTriangleMeshShape(std::unique_ptr<btStridingMeshInterface> triangle_mesh) noexcept :
 			_triangle_mesh(std::move(triangle_mesh)),
-			_triangle_mesh_shape(_triangle_mesh.get(), true)
+			_triangle_mesh_shape(_triangle_mesh.get(), true),
+			_scaled_shape(&_triangle_mesh_shape, btVector3(1, 1, 1))
 		{}
 
+		/*
+		 * Uses a BVH built earlier over the same unscaled mesh instead of building one.
+		 * Neither the mesh data nor bvh are copied, so storage should own them both.
+		 */
+		[[nodiscard]] BvhTriangleMeshShape(
+			std::unique_ptr<btStridingMeshInterface> triangle_mesh,
+			btOptimizedBvh &bvh,
+			std::shared_ptr<const void> storage
+		) noexcept :
+			_storage(std::move(storage)),
+			_triangle_mesh(std::move(triangle_mesh)),
+			_triangle_mesh_shape(_triangle_mesh.get(), true, false),
+			_scaled_shape(&_triangle_mesh_shape, btVector3(1, 1, 1))
+		{
+			_triangle_mesh_shape.setOptimizedBvh(&bvh);
+		}
+
 	}; // class BvhTriangleMeshShape
 
 } // namespace infd::scene::physics
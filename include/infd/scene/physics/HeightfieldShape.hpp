@@ -0,0 +1,77 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <vector>
+
+// bullet
+#include <BulletCollision/CollisionShapes/btCollisionShape.h>
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+
+// glm
+#include <glm/vec3.hpp>
+
+// project - math
+#include <infd/math/glm_bullet.hpp>
+
+// project - scene::physics
+#include <infd/scene/physics/physics.hpp>
+
+
+namespace infd::scene::physics {
+
+	/*
+	 * Static terrain collision over a regular grid of heights, without building a triangle mesh or BVH.
+	 *
+	 * heights holds width * length samples, row-major along x, spaced cell_size apart.
+	 * Like btHeightfieldTerrainShape, the shape is centred on its SceneObject: place the SceneObject
+	 * at centre() relative to the first sample for the grid to line up with it.
+	 */
+	class HeightfieldShape : public CollisionShape {
+		std::vector<float> _heights;
+		int _width;
+		int _length;
+		float _min_height;
+		float _max_height;
+		glm::vec<3, Float> _grid_scaling;
+		// must be declared after _heights, which it points into
+		btHeightfieldTerrainShape _heightfield_shape;
+
+		[[nodiscard]] btCollisionShape& getBtCollisionShape() noexcept override {
+			return _heightfield_shape;
+		}
+
+		[[nodiscard]] const btCollisionShape& getBtCollisionShape() const noexcept override {
+			return _heightfield_shape;
+		}
+
+		void syncCollisionShapeScaling() override {
+			_heightfield_shape.setLocalScaling(
+				math::toBullet(_grid_scaling * transform().localScale())
+			);
+		}
+
+	public:
+		[[nodiscard]] HeightfieldShape(std::vector<float> heights, int width, int length, Float cell_size) :
+			_heights(std::move(heights)),
+			_width(width),
+			_length(length),
+			_min_height(*std::min_element(_heights.begin(), _heights.end())),
+			_max_height(*std::max_element(_heights.begin(), _heights.end())),
+			_grid_scaling(cell_size, 1, cell_size),
+			_heightfield_shape(width, length, _heights.data(), _min_height, _max_height, 1, false) {}
+
+		/*
+		 * Position of the shape's origin relative to the first sample, in unscaled units.
+		 */
+		[[nodiscard]] glm::vec<3, Float> centre() const noexcept {
+			return {
+				_grid_scaling.x * static_cast<Float>(_width - 1) / 2,
+				(_min_height + _max_height) / 2,
+				_grid_scaling.z * static_cast<Float>(_length - 1) / 2
+			};
+		}
+
+	}; // class HeightfieldShape
+
+} // namespace infd::scene::physics
@@ -70,6 +70,13 @@ namespace infd::scene::physics {
 	public:
 		[[nodiscard]] PhysicsContext() noexcept;
 
+		/*
+		 * Calls fn(aabb_min, aabb_max) with the world space bounds of every simulated body that 
+		 * isn't static, i.e. everything that can move into something else.
+		 */
+		template <typename Fn>
+		void forEachDynamicBounds(Fn&& fn) const;
+
 
 	}; // class PhysicsContext
 
@@ -42,6 +42,7 @@ namespace infd::scene::physics {
 		std::unique_ptr<btMotionState> _motion_state{nullptr};
 		std::unique_ptr<btRigidBody> _rigid_body;
 		LifeSpanHandle _life_span_handle;
+		bool _simulated = true;
 
 		util::PropertyOwner<bool> _transform_ignore_parent;
 
@@ -143,6 +144,14 @@ namespace infd::scene::physics {
 		[[nodiscard]] glm::vec<3, Float> centerOfMassPosition() const noexcept;
 		void centerOfMassPosition(const glm::vec<3, Float>& value) noexcept;
 
+		[[nodiscard]] bool simulated() const noexcept;
+
+		/*
+		 * Adds or removes the body from the dynamics world, keeping all of its state. Bodies that 
+		 * aren't awakened yet join the world on awake only if simulated.
+		 */
+		void simulated(bool value) noexcept;
+
 	}; // class Rigidbody
 
 } // namespace infd::scene::physics
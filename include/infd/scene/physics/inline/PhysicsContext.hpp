@@ -8,6 +8,9 @@
 // bullet
 #include <btBulletDynamicsCommon.h>
 
+// project - math
+#include <infd/math/glm_bullet.hpp>
+
 // project - declarations
 #include <infd/scene/physics/decl/PhysicsContext.hpp>
 #include <infd/scene/physics/decl/RigidBody.hpp>
@@ -70,4 +73,17 @@ namespace infd::scene::physics {
 		return _rigid_body_life_spans.emplace_back(*this, rigid_body);
 	}
 
+	template <typename Fn>
+	void PhysicsContext::forEachDynamicBounds(Fn&& fn) const {
+		for (const RigidBodyLifeSpan& life_span : _rigid_body_life_spans) {
+			const RigidBody& rigid_body = life_span.rigidBody();
+			if (rigid_body.isStatic()) continue;
+
+			btVector3 aabb_min;
+			btVector3 aabb_max;
+			rigid_body._rigid_body->getAabb(aabb_min, aabb_max);
+			fn(math::toGlm(aabb_min), math::toGlm(aabb_max));
+		}
+	}
+
 } // namespace infd::scene::physics
@@ -6,7 +6,11 @@ uniform mat4 uModelMatrix;
 uniform mat4 uViewMatrix;
 
 uniform vec3 uColour;
+// see RenderComponent::material.secondary_colour
+uniform bool uTwoTone;
+uniform vec3 uSecondaryColour;
 uniform float uShininess;
+uniform bool uFlatShading;
 
 uniform vec3 uLightDir;
 uniform vec3 uCameraPos;
@@ -26,12 +30,19 @@ out vec4 fb_color;
 
 void main() {
     vec3 N = normalize(f_in.normal);
+    if (uFlatShading) {
+        // face normal from the screen space derivatives, so shared vertices don't smooth the facets away
+        vec3 face = normalize(cross(dFdx(f_in.position), dFdy(f_in.position)));
+        N = dot(face, N) < 0 ? -face : face;
+    }
     vec3 V = normalize(uCameraPos - f_in.position);
     vec3 L = normalize(-uLightDir);
     vec3 H = normalize(L + V);
 
-    vec3 ambient = 0.3 * uColour;
-    vec3 diffuse = max(dot(N, L), 0) * uColour;
+    vec3 albedo = uTwoTone && f_in.textureCoord.x > 0.5 ? uSecondaryColour : uColour;
+
+    vec3 ambient = 0.3 * albedo;
+    vec3 diffuse = max(dot(N, L), 0) * albedo;
     vec3 specular = vec3(max(pow(dot(N, H), uShininess), 0));
 
     // attenuate channels to avoid overblown highlights
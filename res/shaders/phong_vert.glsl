@@ -6,6 +6,11 @@ uniform mat4 uModelMatrix;
 uniform mat4 uViewMatrix;
 uniform vec3 uColour;
 
+// terrain displacement, see RenderComponent::displacement
+uniform bool uDisplaced;
+uniform sampler2D uHeights;
+uniform float uSkirtDepth;
+
 // mesh data
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
@@ -18,14 +23,40 @@ out VertexData {
     vec2 textureCoord;
 } v_out;
 
+// height of grid vertex (i, j) held in a texture coordinate, the texels start one vertex outside the grid
+float heightAt(ivec2 vertex) {
+    return texelFetch(uHeights, vertex + 1, 0).r;
+}
+
 void main() {
+    vec3 position = aPosition;
+    vec3 normal = aNormal;
+
+    if (uDisplaced) {
+        ivec2 vertex = ivec2(aTexCoord);
+        position.y = heightAt(vertex);
+
+        if (aNormal.y == 0.0) {
+            // skirts keep their outward normals
+            position.y -= uSkirtDepth;
+        } else {
+            // central differences, as Heightfield::normal
+            float resolution = float(textureSize(uHeights, 0).x - 3);
+            normal = normalize(vec3(
+                heightAt(vertex - ivec2(1, 0)) - heightAt(vertex + ivec2(1, 0)),
+                2.0 / resolution,
+                heightAt(vertex - ivec2(0, 1)) - heightAt(vertex + ivec2(0, 1))
+            ));
+        }
+    }
+
     // transform vertex data to viewspace
     mat4 modelView = uViewMatrix * uModelMatrix;
 
-    v_out.position = (uModelMatrix * vec4(aPosition, 1)).xyz;
-    v_out.normal = normalize((uModelMatrix * vec4(aNormal, 0)).xyz);
+    v_out.position = (uModelMatrix * vec4(position, 1)).xyz;
+    v_out.normal = normalize((uModelMatrix * vec4(normal, 0)).xyz);
     v_out.textureCoord = aTexCoord;
 
     // set the screenspace position (needed for converting to fragment data)
-    gl_Position = uProjectionMatrix * modelView * vec4(aPosition, 1);
+    gl_Position = uProjectionMatrix * modelView * vec4(position, 1);
 }
\ No newline at end of file
@@ -5,14 +5,31 @@ uniform mat4 uProjectionMatrix;
 uniform mat4 uModelMatrix;
 uniform mat4 uViewMatrix;
 
+// terrain displacement, see RenderComponent::displacement
+uniform bool uDisplaced;
+uniform sampler2D uHeights;
+uniform float uSkirtDepth;
+
 // mesh data
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoord;
 
+// height of grid vertex (i, j) held in a texture coordinate, the texels start one vertex outside the grid
+float heightAt(ivec2 vertex) {
+    return texelFetch(uHeights, vertex + 1, 0).r;
+}
+
 void main() {
+    vec3 position = aPosition;
+    if (uDisplaced) {
+        position.y = heightAt(ivec2(aTexCoord));
+        // skirts have horizontal normals
+        if (aNormal.y == 0.0) position.y -= uSkirtDepth;
+    }
+
     // transform vertex data to viewspace
     mat4 modelView = uViewMatrix * uModelMatrix;
 
-    gl_Position = (uProjectionMatrix * modelView) * vec4(aPosition, 1);
+    gl_Position = (uProjectionMatrix * modelView) * vec4(position, 1);
 }
\ No newline at end of file
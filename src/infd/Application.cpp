@@ -1,4 +1,5 @@
 // std
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -192,11 +193,24 @@ namespace infd {
 		camera.emplaceComponent<render::DitherSettingsComponent>();
 		camera.emplaceComponent<scene::LookAtParent>();
         scene::SceneObject& chunkLoader = _scene.addSceneObject(std::make_unique<scene::SceneObject>("ChunkLoader"));
-        auto& loader = chunkLoader.emplaceComponent<generator::ChunkLoader>(chunkLoader, _renderer, 2);
+        // Chunks are only cached on disk between runs if INFD_CHUNK_CACHE names a directory for them.
+        const char* chunk_cache = std::getenv("INFD_CHUNK_CACHE");
+        auto& loader = chunkLoader.emplaceComponent<generator::ChunkLoader>(
+            chunkLoader, _renderer, 3, 0, 0, 0, chunk_cache ? chunk_cache : ""
+        );
         loader.transform().localScale(glm::vec3(WORLD_SCALE));
+        // Draw out to the last of the far chunks, the near plane moving out with it.
+        camera.getComponent<render::CameraComponent>()->far_plane = loader.horizon();
 
+        // Stream the world ahead of the car rather than around the camera orbiting it.
+        loader.follow(car.getComponent<scene::physics::RigidBody>());
         _chunk_loader = &loader;
 
+        // Drop the car just above the ground, wherever that is for this seed.
+        glm::vec3 car_position = car.transform().localPosition();
+        car_position.y = loader.heightAt(car_position.x, car_position.z) + 5;
+        car.transform().localPosition(car_position);
+
         // scene::SceneObject& light = _scene.addSceneObject(std::make_unique<scene::SceneObject>("Light"));
         // light.emplaceComponent<render::DirectionalLightComponent>();
 	}
@@ -287,6 +301,8 @@ namespace infd {
 		ImGui::Separator();
 
 		_renderer.gui();
+        ImGui::Separator();
+        _chunk_loader->gui();
         ImGui::Separator();
 		ImGui::Checkbox("Render un-dithered scene", &_render_settings.render_original);
         ImGui::Checkbox("Render wireframe", &_render_settings.render_wireframe);
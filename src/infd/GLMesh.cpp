@@ -10,6 +10,16 @@
 namespace infd {
 
 	GLMesh GLMeshBuilder::build() const {
+		return build(mode, vertices.data(), vertices.size(), indices.data(), indices.size());
+	}
+
+	GLMesh GLMeshBuilder::build(
+		GLenum mode,
+		const MeshVertex *vertices,
+		std::size_t vertex_count,
+		const unsigned int *indices,
+		std::size_t index_count
+	) {
 		GLVertexArray vao;
 		GLBuffer vbo;
 		GLBuffer ibo;
@@ -19,7 +29,7 @@ namespace infd {
 
 		// --------------------VBO--------------------
 		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshVertex), vertices.data(), GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(MeshVertex), vertices, GL_STATIC_DRAW);
 
 		// position
 		glEnableVertexAttribArray(0);
@@ -35,9 +45,7 @@ namespace infd {
 		// --------------------IBO--------------------
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
 		// indices
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-		std::size_t index_count = indices.size();
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
 		glBindVertexArray(0);
 
@@ -0,0 +1,62 @@
+#include "infd/generator/Arena.hpp"
+#include "infd/generator/util/parallel.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace infd::generator {
+    void* Arena::Slot::allocate(size_t bytes, size_t alignment) {
+        for (; block < blocks.size(); block++, used = 0) {
+            void* next = blocks[block].get() + used;
+            size_t space = sizes[block] - used;
+            if (std::align(alignment, bytes, next, space)) {
+                used = sizes[block] - space + bytes;
+                return next;
+            }
+        }
+
+        // Leaves room to align within, as new only aligns to the default.
+        size_t size = std::max({BLOCK_SIZE, bytes + alignment, sizes.empty() ? 0 : 2 * sizes.back()});
+        blocks.emplace_back(new std::byte[size]);
+        sizes.push_back(size);
+
+        void* next = blocks.back().get();
+        size_t space = size;
+        std::align(alignment, bytes, next, space);
+        used = size - space + bytes;
+        return next;
+    }
+
+    void Arena::Slot::reset() {
+        if (blocks.size() > 1) {
+            size_t size = std::accumulate(sizes.begin(), sizes.end(), size_t(0));
+            blocks.clear();
+            blocks.emplace_back(new std::byte[size]);
+            sizes.assign(1, size);
+        }
+
+        block = 0;
+        used = 0;
+    }
+
+    Arena::Arena() : _slots(helpers::threadCount()) {}
+
+    void* Arena::do_allocate(size_t bytes, size_t alignment) {
+        size_t index = helpers::threadIndex();
+        if (index < _slots.size()) return _slots[index].allocate(bytes, alignment);
+
+        std::lock_guard lock(_overflowMutex);
+        return _overflow.allocate(bytes, alignment);
+    }
+
+    bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    void Arena::reset() {
+        for (Slot& slot : _slots) {
+            slot.reset();
+        }
+        _overflow.reset();
+    }
+}
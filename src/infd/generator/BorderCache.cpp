@@ -0,0 +1,59 @@
+#include "infd/generator/BorderCache.hpp"
+
+#include <algorithm>
+
+namespace infd::generator {
+    std::uint64_t BorderCache::key(int x, int y, Border::Side side) {
+        // 31 bits per coordinate is plenty, the last bit is the side.
+        std::uint64_t packedX = std::uint32_t(x) & 0x7fffffffu;
+        std::uint64_t packedY = std::uint32_t(y) & 0x7fffffffu;
+        return (packedX << 32) | (packedY << 1) | static_cast<std::uint64_t>(side);
+    }
+
+    std::shared_ptr<const Border> BorderCache::find(std::uint64_t key) {
+        std::lock_guard lock(_mutex);
+
+        auto it = _borders.find(key);
+        std::shared_ptr<const Border> border = it != _borders.end() ? it->second.lock() : nullptr;
+        if (border) {
+            _hits++;
+        } else {
+            _misses++;
+        }
+        return border;
+    }
+
+    std::shared_ptr<const Border> BorderCache::insert(std::uint64_t key, std::shared_ptr<const Border> border) {
+        std::lock_guard lock(_mutex);
+
+        std::weak_ptr<const Border>& entry = _borders[key];
+        if (std::shared_ptr<const Border> existing = entry.lock()) return existing;
+        entry = border;
+
+        if (_borders.size() > _sweepAt) {
+            for (auto it = _borders.begin(); it != _borders.end();) {
+                it = it->second.expired() ? _borders.erase(it) : std::next(it);
+            }
+            _sweepAt = std::max<size_t>(64, 2 * _borders.size());
+        }
+
+        return border;
+    }
+
+    size_t BorderCache::size() const {
+        std::lock_guard lock(_mutex);
+        return static_cast<size_t>(std::count_if(_borders.begin(), _borders.end(), [](const auto& entry) {
+            return !entry.second.expired();
+        }));
+    }
+
+    size_t BorderCache::hits() const {
+        std::lock_guard lock(_mutex);
+        return _hits;
+    }
+
+    size_t BorderCache::misses() const {
+        std::lock_guard lock(_mutex);
+        return _misses;
+    }
+}
@@ -0,0 +1,61 @@
+#include "infd/generator/ChunkCache.hpp"
+#include "infd/generator/MappedFile.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <random>
+#include <string>
+#include <system_error>
+
+namespace infd::generator {
+    ChunkCache::ChunkCache(const std::filesystem::path& root, unsigned int seed) :
+        _directory(root / std::to_string(seed)), _seed(seed) {
+        // Failing here only means every store fails too.
+        std::error_code error;
+        std::filesystem::create_directories(_directory, error);
+    }
+
+    const std::filesystem::path& ChunkCache::directory() const {
+        return _directory;
+    }
+
+    std::filesystem::path ChunkCache::path(int x, int y) const {
+        return _directory / (std::to_string(x) + "_" + std::to_string(y) + ".chunk");
+    }
+
+    std::unique_ptr<ChunkFile> ChunkCache::load(int x, int y) const {
+        std::shared_ptr<MappedFile> mapped = MappedFile::open(path(x, y));
+        if (!mapped) return nullptr;
+
+        std::byte* data = mapped->data();
+        size_t size = mapped->size();
+        std::unique_ptr<ChunkFile> file = ChunkFile::open(std::move(mapped), data, size);
+
+        if (!file || file->seed != _seed || file->x != x || file->y != y) return nullptr;
+        return file;
+    }
+
+    bool ChunkCache::store(int x, int y, const ChunkFile::Buffer& bytes) const {
+        // Unique per call and per process, so concurrent stores of the same chunk, e.g. from the game and the bake
+        // tool, don't write over each other's temporary files.
+        static const unsigned int process = std::random_device()();
+        static std::atomic<unsigned long long> counter = 0;
+
+        std::filesystem::path target = path(x, y);
+        std::filesystem::path temporary = target;
+        temporary += "." + std::to_string(process) + "." + std::to_string(counter++) + ".tmp";
+
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        out.close();
+
+        std::error_code error;
+        if (out) {
+            std::filesystem::rename(temporary, target, error);
+            if (!error) return true;
+        }
+
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+}
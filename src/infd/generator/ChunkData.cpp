@@ -0,0 +1,93 @@
+#include "infd/generator/ChunkData.hpp"
+#include "infd/generator/Arena.hpp"
+#include "infd/generator/meshbuilding/RoadMeshBuilder.hpp"
+#include "infd/generator/meshbuilding/BuildingMeshBuilder.hpp"
+#include "infd/generator/util/helpers.hpp"
+#include "infd/generator/util/parallel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace infd::generator {
+    ChunkData::ChunkData(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, const std::atomic<bool>& cancelled,
+                         StageTimes* times, BorderCache* borderCache) :
+        ChunkData(x, y, seed, perlinNoise, borderCache, helpers::deferred) {
+        generate(cancelled, times, std::numeric_limits<size_t>::max()).run();
+    }
+
+    ChunkData::ChunkData(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, BorderCache* borderCache,
+                         helpers::Deferred) :
+        generator(x, y, seed, perlinNoise, borderCache, helpers::deferred) {}
+
+    helpers::Steps ChunkData::generate(const std::atomic<bool>& cancelled, StageTimes* times, size_t batch) {
+        co_yield generator.generate(times);
+        if (cancelled) co_return;
+
+        // Scratch space for the meshes, given back once each is copied out to the data.
+        Arena arena;
+
+        meshbuilding::RoadMeshBuilder roadBuilder(generator, &arena);
+        co_yield StageTimes::time(times, &StageTimes::roadMesh, roadBuilder.build(roads, batch));
+        arena.reset();
+
+        buildings.resize(generator.cycles.size());
+        for (size_t begin = 0, count; begin < buildings.size(); begin += count) {
+            if (cancelled) co_return;
+            count = std::min(batch, buildings.size() - begin);
+
+            StageTimes::time(times, &StageTimes::buildingMeshes, [&] {
+                // Every building draws from a stream of its own, so they can be built concurrently and still come
+                // out the same whatever the thread count.
+                helpers::parallelFor(count, [&](size_t j) {
+                    if (cancelled) return;
+
+                    size_t i = begin + j;
+                    glm::vec3 colour;
+                    helpers::RandomType random = buildingRandom(generator, i, colour);
+                    meshbuilding::BuildingMeshBuilder builder(generator, generator.cycles[i], random, &arena);
+                    buildings[i] = {builder.build(), colour};
+                });
+            });
+            arena.reset();
+            co_yield helpers::pause;
+        }
+        if (cancelled) co_return;
+
+        fitBuildings();
+    }
+
+    void ChunkData::fitBuildings() {
+        std::vector<std::uint8_t> kept(buildings.size(), false);
+        size_t triangles = 0;
+        for (size_t i : generator.cycleOrder()) {
+            size_t count = buildings[i].data.mesh.indices.size() / 3;
+            if (triangles + count > generator.budget.buildingTriangles) continue;
+
+            kept[i] = true;
+            triangles += count;
+        }
+
+        // The rest stay in the order they were built. Moving a building onto itself would empty it.
+        size_t next = 0;
+        for (size_t i = 0; i < buildings.size(); i++) {
+            if (!kept[i]) continue;
+
+            if (next != i) buildings[next] = std::move(buildings[i]);
+            next++;
+        }
+
+        if (next == buildings.size()) return;
+        generator.overBudget = true;
+        buildings.resize(next);
+    }
+
+    helpers::RandomType ChunkData::buildingRandom(const ChunkGenerator& generator, size_t i, glm::vec3& colour) {
+        helpers::RandomType random = helpers::itemRandom(generator.x, generator.y, generator.seed,
+                                                         helpers::Stream::Building, static_cast<std::uint32_t>(i));
+        for (int channel = 0; channel < 3; channel++) {
+            colour[channel] = random.uniform(MIN_BUILDING_COLOUR, MAX_BUILDING_COLOUR);
+        }
+        return random;
+    }
+}
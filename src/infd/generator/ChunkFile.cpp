@@ -0,0 +1,315 @@
+#include "infd/generator/ChunkFile.hpp"
+#include "infd/generator/ChunkGenerator.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+
+namespace infd::generator {
+    namespace {
+        const char MAGIC[8] = {'I', 'N', 'F', 'D', 'C', 'H', 'N', 'K'};
+        // Reads back differently on a machine with the other byte order.
+        const std::uint32_t ENDIANNESS_MARKER = 0x01020304;
+        const size_t ALIGNMENT = 16;
+
+        static_assert(std::is_same_v<btScalar, float>, "chunk files store collision vertices as floats");
+        static_assert(std::is_trivially_copyable_v<MeshVertex> && sizeof(MeshVertex) == 8 * sizeof(float));
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder;
+            std::uint32_t seed;
+            std::int32_t x;
+            std::int32_t y;
+            std::uint32_t resolution;
+            // Of the whole file, to catch truncation.
+            std::uint64_t size;
+            // (resolution + 3)^2 floats, laid out as Heightfield::samples.
+            std::uint64_t heights;
+            // meshCount MeshRecords, the roads followed by each building.
+            std::uint64_t meshes;
+            std::uint32_t meshCount;
+            std::uint32_t padding;
+        };
+
+        // Offsets are from the start of the file.
+        struct MeshRecord {
+            std::uint32_t mode;
+            float colour[3];
+            float aabbMin[4];
+            float aabbMax[4];
+
+            std::uint32_t vertexCount;
+            std::uint32_t indexCount;
+            // Four floats per vertex and three ints per triangle, as btTriangleMesh keeps them.
+            std::uint32_t collisionVertexCount;
+            std::uint32_t collisionTriangleCount;
+
+            std::uint64_t vertices;
+            std::uint64_t indices;
+            std::uint64_t collisionVertices;
+            std::uint64_t collisionIndices;
+            std::uint64_t bvh;
+            std::uint64_t bvhSize;
+        };
+
+        size_t align(size_t offset) {
+            return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        class Writer {
+        public:
+            ChunkFile::Buffer bytes;
+
+            size_t reserve(size_t size) {
+                size_t offset = align(bytes.size());
+                bytes.resize(offset + size);
+                return offset;
+            }
+
+            template <typename T>
+            size_t write(const T* values, size_t count) {
+                size_t offset = reserve(count * sizeof(T));
+                if (count > 0) std::memcpy(bytes.data() + offset, values, count * sizeof(T));
+                return offset;
+            }
+        };
+
+        MeshRecord writeMesh(Writer& writer, const meshbuilding::MeshData& data, glm::vec3 colour) {
+            MeshRecord record{};
+            record.mode = data.mesh.mode;
+            std::copy_n(&colour[0], 3, record.colour);
+
+            record.vertexCount = static_cast<std::uint32_t>(data.mesh.vertices.size());
+            record.indexCount = static_cast<std::uint32_t>(data.mesh.indices.size());
+            record.vertices = writer.write(data.mesh.vertices.data(), data.mesh.vertices.size());
+            record.indices = writer.write(data.mesh.indices.data(), data.mesh.indices.size());
+
+            btTriangleMesh& triangles = *data.tri_mesh;
+            if (triangles.getNumTriangles() == 0) return record;
+
+            const unsigned char* vertexBase;
+            int vertexCount;
+            PHY_ScalarType vertexType;
+            int vertexStride;
+            const unsigned char* indexBase;
+            int indexStride;
+            int triangleCount;
+            PHY_ScalarType indexType;
+            triangles.getLockedReadOnlyVertexIndexBase(&vertexBase, vertexCount, vertexType, vertexStride,
+                                                       &indexBase, indexStride, triangleCount, indexType);
+
+            // btTriangleMesh defaults to exactly this, and the builders never change it.
+            if (vertexType != PHY_FLOAT || vertexStride != sizeof(btVector3) ||
+                indexType != PHY_INTEGER || indexStride != 3 * sizeof(int)) {
+                throw std::logic_error("Unexpected collision mesh layout");
+            }
+
+            record.collisionVertexCount = static_cast<std::uint32_t>(vertexCount);
+            record.collisionTriangleCount = static_cast<std::uint32_t>(triangleCount);
+            record.collisionVertices = writer.write(vertexBase, static_cast<size_t>(vertexCount) * vertexStride);
+            record.collisionIndices = writer.write(indexBase, static_cast<size_t>(triangleCount) * indexStride);
+
+            const auto* vertices = reinterpret_cast<const btVector3*>(vertexBase);
+            btVector3 aabbMin = vertices[0];
+            btVector3 aabbMax = vertices[0];
+            for (int i = 1; i < vertexCount; i++) {
+                aabbMin.setMin(vertices[i]);
+                aabbMax.setMax(vertices[i]);
+            }
+            std::copy_n(aabbMin.m_floats, 4, record.aabbMin);
+            std::copy_n(aabbMax.m_floats, 4, record.aabbMax);
+
+            // Built over the unscaled triangles, exactly as BvhTriangleMeshShape would.
+            btBvhTriangleMeshShape shape(&triangles, true);
+            const btOptimizedBvh& bvh = *shape.getOptimizedBvh();
+
+            record.bvhSize = bvh.calculateSerializeBufferSize();
+            record.bvh = writer.reserve(record.bvhSize);
+            bvh.serializeInPlace(writer.bytes.data() + record.bvh, static_cast<unsigned int>(record.bvhSize), false);
+
+            return record;
+        }
+
+        class Reader {
+            std::byte* _bytes;
+            size_t _size;
+
+        public:
+            Reader(std::byte* bytes, size_t size) : _bytes(bytes), _size(size) {}
+
+            /**
+             * The section of count values at offset, or nullptr if it's misaligned or runs past the end.
+             */
+            template <typename T>
+            T* section(std::uint64_t offset, std::uint64_t count) const {
+                if (offset % ALIGNMENT != 0 || offset > _size) return nullptr;
+                if (count > (_size - offset) / sizeof(T)) return nullptr;
+                return reinterpret_cast<T*>(_bytes + offset);
+            }
+        };
+
+        /**
+         * Whether every index is below count. Indices are used straight from the file, so one past the end would read
+         * out of bounds.
+         */
+        template <typename T>
+        bool inRange(const T* indices, size_t indexCount, std::uint64_t count) {
+            // Negative ones wrap around past any count.
+            return std::all_of(indices, indices + indexCount, [&](T index) {
+                return std::uint64_t(std::make_unsigned_t<T>(index)) < count;
+            });
+        }
+
+        /**
+         * Whether every node of the BVH, as writeMesh builds it, stays within the tree and the triangleCount triangles
+         * of its single part, so walking it can't leave either.
+         */
+        bool validBvh(btOptimizedBvh& bvh, std::uint32_t triangleCount) {
+            if (!bvh.isQuantized()) return false;
+
+            const QuantizedNodeArray& nodes = bvh.getQuantizedNodeArray();
+            for (int i = 0; i < nodes.size(); i++) {
+                const btQuantizedBvhNode& node = nodes[i];
+                if (node.isLeafNode()) {
+                    if (node.getPartId() != 0 || std::uint32_t(node.getTriangleIndex()) >= triangleCount) return false;
+                } else if (node.getEscapeIndex() < 1 || node.getEscapeIndex() > nodes.size() - i) {
+                    return false;
+                }
+            }
+
+            const BvhSubtreeInfoArray& subtrees = bvh.getSubtreeInfoArray();
+            for (int i = 0; i < subtrees.size(); i++) {
+                const btBvhSubtreeInfo& subtree = subtrees[i];
+                if (subtree.m_rootNodeIndex < 0 || subtree.m_subtreeSize < 1 ||
+                    subtree.m_subtreeSize > nodes.size() - subtree.m_rootNodeIndex) return false;
+            }
+            return true;
+        }
+
+        bool readMesh(const Reader& reader, const MeshRecord& record, ChunkFile::Mesh& mesh) {
+            mesh.mode = record.mode;
+            mesh.colour = glm::vec3(record.colour[0], record.colour[1], record.colour[2]);
+
+            mesh.vertexCount = record.vertexCount;
+            mesh.indexCount = record.indexCount;
+            mesh.vertices = reader.section<const MeshVertex>(record.vertices, record.vertexCount);
+            mesh.indices = reader.section<const unsigned int>(record.indices, record.indexCount);
+            if (!mesh.vertices || !mesh.indices) return false;
+            if (!inRange(mesh.indices, mesh.indexCount, mesh.vertexCount)) return false;
+
+            if (record.collisionTriangleCount == 0) return true;
+
+            auto* vertices = reader.section<btScalar>(record.collisionVertices, 4 * std::uint64_t(record.collisionVertexCount));
+            auto* indices = reader.section<int>(record.collisionIndices, 3 * std::uint64_t(record.collisionTriangleCount));
+            auto* bvh = reader.section<std::byte>(record.bvh, record.bvhSize);
+            if (!vertices || !indices || !bvh || record.bvhSize > std::numeric_limits<unsigned int>::max()) return false;
+            if (!inRange(indices, 3 * size_t(record.collisionTriangleCount), record.collisionVertexCount)) return false;
+
+            mesh.bvh = btOptimizedBvh::deSerializeInPlace(bvh, static_cast<unsigned int>(record.bvhSize), false);
+            if (!mesh.bvh || !validBvh(*mesh.bvh, record.collisionTriangleCount)) return false;
+
+            mesh.collision = std::make_unique<btTriangleIndexVertexArray>(
+                    static_cast<int>(record.collisionTriangleCount), indices, static_cast<int>(3 * sizeof(int)),
+                    static_cast<int>(record.collisionVertexCount), vertices, static_cast<int>(sizeof(btVector3))
+            );
+            // Saves Bullet a pass over every vertex to find the bounds.
+            mesh.collision->setPremadeAabb(
+                    btVector3(record.aabbMin[0], record.aabbMin[1], record.aabbMin[2]),
+                    btVector3(record.aabbMax[0], record.aabbMax[1], record.aabbMax[2])
+            );
+            return true;
+        }
+    }
+
+    ChunkFile::Buffer ChunkFile::serialize(const ChunkData& data) {
+        Buffer bytes;
+        serialize(data, bytes, std::numeric_limits<size_t>::max()).run();
+        return bytes;
+    }
+
+    helpers::Steps ChunkFile::serialize(const ChunkData& data, Buffer& out, size_t batch) {
+        const ChunkGenerator& generator = data.generator;
+        const std::vector<float>& samples = generator.heightfield.samples();
+
+        Writer writer;
+        size_t headerOffset = writer.reserve(sizeof(Header));
+
+        Header header{};
+        std::copy_n(MAGIC, sizeof(MAGIC), header.magic);
+        header.version = VERSION;
+        header.byteOrder = ENDIANNESS_MARKER;
+        header.seed = generator.seed;
+        header.x = generator.x;
+        header.y = generator.y;
+        header.resolution = generator.heightfield.resolution();
+        header.heights = writer.write(samples.data(), samples.size());
+
+        std::vector<MeshRecord> records;
+        records.reserve(1 + data.buildings.size());
+        records.push_back(writeMesh(writer, data.roads, glm::vec3(0.5)));
+        co_yield helpers::pause;
+
+        for (size_t i = 0; i < data.buildings.size(); i++) {
+            const ChunkData::Building& building = data.buildings[i];
+            records.push_back(writeMesh(writer, building.data, building.colour));
+            if ((i + 1) % batch == 0) co_yield helpers::pause;
+        }
+
+        header.meshCount = static_cast<std::uint32_t>(records.size());
+        header.meshes = writer.write(records.data(), records.size());
+        header.size = writer.bytes.size();
+
+        std::memcpy(writer.bytes.data() + headerOffset, &header, sizeof(Header));
+        out = std::move(writer.bytes);
+    }
+
+    std::unique_ptr<ChunkFile> ChunkFile::open(std::shared_ptr<void> storage, std::byte* bytes, size_t size) {
+        Reader reader(bytes, size);
+
+        const Header* header = reader.section<const Header>(0, 1);
+        if (!header || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), header->magic)) return nullptr;
+        if (header->version != VERSION || header->byteOrder != ENDIANNESS_MARKER || header->size != size) return nullptr;
+
+        std::uint64_t stride = std::uint64_t(header->resolution) + 3;
+        const float* samples = reader.section<const float>(header->heights, stride * stride);
+        const MeshRecord* records = reader.section<const MeshRecord>(header->meshes, header->meshCount);
+        if (!samples || !records || header->meshCount == 0) return nullptr;
+
+        std::unique_ptr<ChunkFile> file(new ChunkFile());
+        file->_storage = std::move(storage);
+        file->_size = size;
+        file->seed = header->seed;
+        file->x = header->x;
+        file->y = header->y;
+        file->heightfield = Heightfield(header->resolution, std::vector<float>(samples, samples + stride * stride));
+
+        if (!readMesh(reader, records[0], file->roads)) return nullptr;
+
+        file->buildings.resize(header->meshCount - 1);
+        for (size_t i = 0; i < file->buildings.size(); i++) {
+            if (!readMesh(reader, records[i + 1], file->buildings[i])) return nullptr;
+        }
+
+        return file;
+    }
+
+    std::unique_ptr<ChunkFile> ChunkFile::open(Buffer bytes) {
+        auto storage = std::make_shared<Buffer>(std::move(bytes));
+        std::byte* data = storage->data();
+        size_t size = storage->size();
+        return open(std::move(storage), data, size);
+    }
+
+    const std::shared_ptr<void>& ChunkFile::storage() const {
+        return _storage;
+    }
+
+    size_t ChunkFile::size() const {
+        return _size;
+    }
+}
@@ -1,192 +1,337 @@
+#include <algorithm>
+#include <cmath>
 #include <deque>
-#include <unordered_set>
+#include <numeric>
 #include "infd/generator/ChunkGenerator.hpp"
 #include "infd/generator/util/helpers.hpp"
 #include "infd/generator/PerlinNoise.hpp"
 
 namespace infd::generator {
-    void ChunkGenerator::populateRoots(std::vector<std::shared_ptr<Node>> &roots) {
+    GenerationBudget GenerationBudget::forDensity(float density) {
+        auto scale = [density](size_t min, size_t max) {
+            return min + static_cast<size_t>(std::lround(density * static_cast<float>(max - min)));
+        };
+
+        GenerationBudget budget;
+        budget.depth = static_cast<unsigned int>(scale(MIN_GENERATION_DEPTH, MAX_GENERATION_DEPTH));
+        budget.nodes = scale(MIN_NODE_BUDGET, MAX_NODE_BUDGET);
+        budget.edges = scale(MIN_EDGE_BUDGET, MAX_EDGE_BUDGET);
+        budget.cycles = scale(MIN_CYCLE_BUDGET, MAX_CYCLE_BUDGET);
+        budget.buildingTriangles = scale(MIN_BUILDING_TRIANGLE_BUDGET, MAX_BUILDING_TRIANGLE_BUDGET);
+        return budget;
+    }
+
+    size_t GenerationBudget::estimateTriangles(const Clipper2Lib::PathD& cycle, const Clipper2Lib::RectD& bounds) {
+        // Nothing is left of a block narrower than the road padding on both sides once that's taken off.
+        if (std::min(bounds.Width(), bounds.Height()) <= 2 * ROAD_PADDING_WIDTH) return 0;
+
+        // A pad, walls and a roof cap, each a hull of about as many points as the block. Larger blocks may be
+        // skyscrapers, whose layers don't follow the outline.
+        if (cycle.size() < MAX_KHRUSHCHEVKA) return KHRUSHCHEVKA_TRIANGLES_PER_POINT * cycle.size();
+        return SKYSCRAPER_TRIANGLES;
+    }
+
+    std::shared_ptr<const Border> ChunkGenerator::border(int x, int y, Border::Side side) const {
+        if (!borderCache) return std::make_shared<const Border>(generateBorder(x, y, side, perlinNoise));
+
+        return borderCache->get(x, y, side, [&] { return generateBorder(x, y, side, perlinNoise); });
+    }
+
+    Border ChunkGenerator::generateBorder(int x, int y, Border::Side side, const PerlinNoise& perlinNoise) {
         auto x_ = static_cast<float>(x);
         auto y_ = static_cast<float>(y);
 
-        float centerHighwayFactor = scaledPerlin(x_, y_,perlinNoise);
-        float upHighwayFactor = scaledPerlin(x_, y_-1,perlinNoise);
-        float downHighwayFactor = scaledPerlin(x_, y_+1,perlinNoise);
-        float leftHighwayFactor = scaledPerlin(x_-1, y_,perlinNoise);
-        float rightHighwayFactor = scaledPerlin(x_+1, y_,perlinNoise);
+        // this chunk, then the one across the edge
+        float xs[2] = {x_, side == Border::Side::Right ? x_+1 : x_};
+        float ys[2] = {y_, side == Border::Side::Down ? y_+1 : y_};
+        float highwayFactors[2];
+        scaledPerlin(xs, ys, 2, perlinNoise, HIGHWAY_NOISE, highwayFactors);
+
+        Border border;
+        border.highwayFactor = (highwayFactors[1] + highwayFactors[0]) / 2;
+        auto roadCount = static_cast<size_t>(std::lround(rootDistribution(border.highwayFactor)));
+
+        auto random = helpers::generateRandom<helpers::RandomType>(x, y, side == Border::Side::Down ? 5 : 7);
+        border.positions = helpers::paddedDistribution(roadCount, BORDER_ROOT_PADDING, BORDER_PADDING, random);
+        border.angles.reserve(roadCount);
+        for (size_t i = 0; i < roadCount; i++) {
+            border.angles.push_back(random.uniform(-BORDER_ROOT_ANGLE, BORDER_ROOT_ANGLE));
+        }
 
-        int upRoads = static_cast<int>(std::lround(rootDistribution((upHighwayFactor + centerHighwayFactor) / 2)));
-        int downRoads = static_cast<int>(std::lround(rootDistribution((downHighwayFactor + centerHighwayFactor) / 2)));
-        int leftRoads = static_cast<int>(std::lround(rootDistribution((leftHighwayFactor + centerHighwayFactor) / 2)));
-        int rightRoads = static_cast<int>(std::lround(rootDistribution((rightHighwayFactor + centerHighwayFactor) / 2)));
+        return border;
+    }
 
-        roots.reserve(upRoads + downRoads + leftRoads + rightRoads);
+    float ChunkGenerator::density(int x, int y, const PerlinNoise& perlinNoise) {
+        float noise = perlinNoise.sample<float>(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, DENSITY_NOISE);
+        return std::clamp(noise + 0.5f, 0.f, 1.f);
+    }
 
-        populateRoots(roots, x_, y_-1, 5, upRoads, 1, [](float f){ return f; }, [](float){ return 0.f; });
-        populateRoots(roots, x_, y_, 5, downRoads, 3, [](float f){ return f; }, [](float){ return 1.f; });
-        populateRoots(roots, x_-1, y_, 7, leftRoads, 0, [](float){ return 0.f; }, [](float f){ return f; });
-        populateRoots(roots, x_, y_, 7, rightRoads, 2, [](float){ return 1.f; }, [](float f){ return f; });
+    void ChunkGenerator::populateRoots() {
+        budget = GenerationBudget::forDensity(density(x, y, perlinNoise));
+
+        // Each edge is keyed by the chunk above or left of it, and is likely already held by that neighbour.
+        borders = {
+            border(x, y-1, Border::Side::Down),
+            border(x, y, Border::Side::Down),
+            border(x-1, y, Border::Side::Right),
+            border(x, y, Border::Side::Right)
+        };
+
+        populateRoots(graph, *borders[0], 1, [](float f){ return f; }, [](float){ return 0.f; });
+        populateRoots(graph, *borders[1], 3, [](float f){ return f; }, [](float){ return 1.f; });
+        populateRoots(graph, *borders[2], 0, [](float){ return 0.f; }, [](float f){ return f; });
+        populateRoots(graph, *borders[3], 2, [](float){ return 1.f; }, [](float f){ return f; });
     }
 
-    void ChunkGenerator::populateRoots(std::vector<std::shared_ptr<Node>> &roots, float x_, float y_, unsigned int seed, size_t roadCount,
-                                       float angleMultiple,
+    void ChunkGenerator::populateRoots(RoadGraph &graph, const Border& border, float angleMultiple,
                                        float (*assignX)(float), float (*assignY)(float)) {
-        auto random = helpers::generateRandom<helpers::RandomType>(x_, y_, seed);
-        std::vector<float> upFloats = helpers::paddedDistribution(roadCount, BORDER_ROOT_PADDING, BORDER_PADDING, random);
-        for (float f : upFloats) {
-            float x_ = assignX(f);
-            float y_ = assignY(f);
-            float angle = angleMultiple*glm::half_pi<float>() + angleDist(random);
-            roots.push_back(std::make_shared<Node>(x_, y_, angle));
+        for (size_t i = 0; i < border.positions.size(); i++) {
+            float x_ = assignX(border.positions[i]);
+            float y_ = assignY(border.positions[i]);
+            float angle = angleMultiple*glm::half_pi<float>() + border.angles[i];
+            graph.addNode(x_, y_, angle);
         }
     }
 
-    ChunkGenerator::ChunkGenerator(int x, int y, unsigned int seed, PerlinNoise &perlinNoise) : x(x), y(y), seed(seed), perlinNoise(perlinNoise) {
-        std::vector<std::shared_ptr<Node>> roots;
-        populateRoots(roots);
-        generateNetwork(roots, GENERATION_DEPTH);
-        trimNetwork();
-        sortEdges();
-        findCycles();
+    ChunkGenerator::ChunkGenerator(int x, int y, unsigned int seed, PerlinNoise &perlinNoise, StageTimes* times,
+                                   BorderCache* borderCache) :
+        ChunkGenerator(x, y, seed, perlinNoise, borderCache, helpers::deferred) {
+        generate(times).run();
+    }
+
+    ChunkGenerator::ChunkGenerator(int x, int y, unsigned int seed, PerlinNoise &perlinNoise, BorderCache* borderCache,
+                                   helpers::Deferred) :
+        x(x), y(y), seed(seed), perlinNoise(perlinNoise), borderCache(borderCache) {}
+
+    helpers::Steps ChunkGenerator::generate(StageTimes* times) {
+        StageTimes::time(times, &StageTimes::heightfield, [&] { heightfield = Heightfield(x, y, TERRAIN_RESOLUTION, perlinNoise); });
+        co_yield helpers::pause;
+        StageTimes::time(times, &StageTimes::populateRoots, [&] { populateRoots(); });
+        co_yield helpers::pause;
+        StageTimes::time(times, &StageTimes::generateNetwork, [&] { generateNetwork(); });
+        co_yield helpers::pause;
+        StageTimes::time(times, &StageTimes::trimNetwork, [&] { trimNetwork(); });
+        co_yield helpers::pause;
+        StageTimes::time(times, &StageTimes::sortEdges, [&] { sortEdges(); });
+        co_yield helpers::pause;
+        StageTimes::time(times, &StageTimes::findCycles, [&] { findCycles(); });
     }
 
     float ChunkGenerator::rootDistribution(float value) {
         return MAX_BORDER_ROOTS * value * value * value * (4 - 3 * value);
     }
 
-    void ChunkGenerator::generateNetwork(std::vector<std::shared_ptr<Node>>& roots, unsigned int depth) {
-        helpers::RandomType random(seed);
-
-        nodes = roots;
-        std::deque<Node*> nodeQueue;
-        for (std::shared_ptr<Node>& node : nodes) {
-            nodeQueue.push_front(node.get());
+    void ChunkGenerator::generateNetwork() {
+        std::deque<NodeIndex> nodeQueue;
+        for (NodeIndex node = 0; node < graph.size(); node++) {
+            nodeQueue.push_front(node);
+            grid.insert(graph, node);
         }
 
         while (!nodeQueue.empty()) {
-            Node* node = nodeQueue.back();
+            NodeIndex node = nodeQueue.back();
             nodeQueue.pop_back();
 
-            if (node->depth > depth) continue;
+            if (graph.depth[node] > budget.depth) continue;
 
-            if (probabilityDist(random) < BRANCH_ROAD_CHANCE && node->neighbours.size() < MAX_NEIGHBOURS) {
+            // Each node is expanded once, from a stream of its own, so its branches don't depend on what was drawn
+            // for any other node.
+            helpers::RandomType random = helpers::itemRandom(x, y, seed, helpers::Stream::Node, node);
+
+            if (random.uniform() < BRANCH_ROAD_CHANCE && graph.degree[node] < MAX_NEIGHBOURS) {
                 addNode(node, nodeQueue, random, -glm::half_pi<float>(), 1);
             }
 
-            if (node->neighbours.size() < MAX_NEIGHBOURS) {
+            if (graph.degree[node] < MAX_NEIGHBOURS) {
                 addNode(node, nodeQueue, random, 0.f, 0);
             }
 
-            if (probabilityDist(random) < BRANCH_ROAD_CHANCE && node->neighbours.size() < MAX_NEIGHBOURS) {
+            if (random.uniform() < BRANCH_ROAD_CHANCE && graph.degree[node] < MAX_NEIGHBOURS) {
                 addNode(node, nodeQueue, random, glm::half_pi<float>(), 1);
             }
         }
     }
 
-    void ChunkGenerator::addNode(Node* parent, std::deque<Node*> &nodeQueue, helpers::RandomType random, float angleOffset, unsigned int offset = 0) {
-        float angle = parent->angle + angleDist(random) + angleOffset;
+    void ChunkGenerator::addNode(NodeIndex parent, std::deque<NodeIndex> &nodeQueue, helpers::RandomType& random, float angleOffset, unsigned int offset = 0) {
+        float angle = graph.angle[parent] + random.uniform(-BORDER_ROOT_ANGLE, BORDER_ROOT_ANGLE) + angleOffset;
 
-        float x_ = parent->x + ROAD_LENGTH * cosf(angle);
-        float y_ = parent->y + ROAD_LENGTH * sinf(angle);
+        float x_ = graph.x[parent] + ROAD_LENGTH * cosf(angle);
+        float y_ = graph.y[parent] + ROAD_LENGTH * sinf(angle);
 
         if (x_ < 0 || x_ > 1 || y_ < 0 || y_ > 1) {
             return;
         }
 
-        Node neighbour(x_, y_, angle, false, parent->depth+1, parent->depth+offset);
+        NodeIndex nearest = grid.findNearest(graph, x_, y_, parent);
 
-        Node* nearest = neighbour.findNearest(parent, nodes);
+        bool edges = graph.edgeCount() / 2 < budget.edges;
 
         if (nearest != parent) {
-            for (Edge& edge : parent->neighbours) {
-                if (edge.to == nearest) {
-                    return;
-                }
+            if (!graph.connected(parent, nearest)) {
+                if (edges) graph.addEdge(parent, nearest);
+                overBudget = overBudget || !edges;
             }
+            return;
+        }
 
-            parent->addNeighbour(nearest);
-            nearest->addNeighbour( parent);
+        // New branches stop first, then every road stops growing.
+        auto nodes = static_cast<size_t>(static_cast<float>(budget.nodes) * (offset ? BRANCH_BUDGET_SHARE : 1.f));
+        if (!edges || graph.size() >= nodes) {
+            overBudget = true;
             return;
         }
 
-        nodes.push_back(std::make_shared<Node>(neighbour));
-        nodeQueue.push_front(nodes.back().get());
+        NodeIndex neighbour = graph.addNode(x_, y_, angle, false, graph.depth[parent]+1, graph.depth[parent]+offset);
+        nodeQueue.push_front(neighbour);
+        grid.insert(graph, neighbour);
 
-        parent->addNeighbour(nodes.back().get());
-        nodes.back()->addNeighbour(parent);
+        graph.addEdge(parent, neighbour);
     }
 
     void ChunkGenerator::trimNetwork() {
-        std::unordered_set<Node*> trimUnique;
-
-        for (std::shared_ptr<Node>& node : nodes) {
-            if (node->neighbours.size() <= 1) {
-                trimUnique.insert(node.get());
+        // Pruning leaves converges to the same network in any order, so a plain stack will do.
+        std::vector<NodeIndex> trimQueue;
+        std::vector<std::uint8_t> queued(graph.size(), false);
+
+        for (NodeIndex node = 0; node < graph.size(); node++) {
+            if (graph.degree[node] <= 1) {
+                trimQueue.push_back(node);
+                queued[node] = true;
             }
         }
 
-        while (!trimUnique.empty()) {
-            Node* node = *trimUnique.begin();
-            trimUnique.erase(node);
-
-            if (!node->isRoot && node->neighbours.size() <= 1) {
-                for (Edge& edge : node->neighbours) {
-                    trimUnique.insert(edge.to);
-                    edge.to->removeNeighbour(node);
-                }
-
-                nodes.erase(
-                        std::remove_if(
-                                nodes.begin(),
-                                nodes.end(),
-                                [&node](std::shared_ptr<Node>& other){ return other.get() == node;}
-                        ),
-                        nodes.end()
-                );
+        while (!trimQueue.empty()) {
+            NodeIndex node = trimQueue.back();
+            trimQueue.pop_back();
+            queued[node] = false;
+
+            if (!graph.isRoot[node] && graph.degree[node] <= 1) {
+                grid.remove(graph, node);
+                graph.removeNode(node, [&](NodeIndex neighbour) {
+                    if (queued[neighbour]) return;
+                    trimQueue.push_back(neighbour);
+                    queued[neighbour] = true;
+                });
             }
         }
+
+        grid.remap(graph.compact());
     }
 
     void ChunkGenerator::sortEdges() {
-        for (std::shared_ptr<Node>& node : nodes) {
-            node->sortNeighbours();
-        }
+        graph.sortEdges();
     }
 
     void ChunkGenerator::findCycles() {
         using namespace Clipper2Lib;
-        for (std::shared_ptr<Node>& node : nodes) {
-            for (Edge& edge : node->neighbours) {
-                if (edge.visited) continue;
-                edge.visited = true;
+
+        // Every half-edge is walked exactly once: each walk marks what it traverses and starts from an unvisited edge.
+        for (NodeIndex node = 0; node < graph.size(); node++) {
+            for (EdgeIndex edge = graph.edgesBegin(node); edge < graph.edgesEnd(node); edge++) {
+                if (graph.edgeVisited[edge]) continue;
+                graph.edgeVisited[edge] = true;
 
                 PathD cycle;
-                cycle.emplace_back(node->x, node->y);
+                cycle.emplace_back(graph.x[node], graph.y[node]);
 
-                Node* initial = node.get();
+                RectD bounds(cycle.back().x, cycle.back().y, cycle.back().x, cycle.back().y);
+                double area = 0;
+                unsigned int category = graph.category[node];
 
-                Node* from = initial;
-                Node* to = edge.to;
+                NodeIndex initial = node;
+
+                EdgeIndex current = edge;
+                NodeIndex to = graph.edgeTo[edge];
 
                 while (to != initial) {
-                    float angle = std::atan2(from->x - to->x, from->y - to->y);
-                    cycle.emplace_back(to->x, to->y);
+                    PointD& previous = cycle.back();
+                    PointD point(graph.x[to], graph.y[to]);
+
+                    area += previous.x * point.y - point.x * previous.y;
+                    bounds.left = std::min(bounds.left, point.x);
+                    bounds.top = std::min(bounds.top, point.y);
+                    bounds.right = std::max(bounds.right, point.x);
+                    bounds.bottom = std::max(bounds.bottom, point.y);
+
+                    cycle.push_back(point);
+                    category = std::max(category, graph.category[to]);
 
-                    from = to;
-                    Edge& nextEdge = to->nextNeighbour(angle);
+                    current = graph.edgeNext[current];
 
-                    nextEdge.visited = true;
-                    to = nextEdge.to;
+                    graph.edgeVisited[current] = true;
+                    to = graph.edgeTo[current];
                 }
 
                 if (cycle.size() < MIN_CYCLE || cycle.size() > MAX_CYCLE) continue;
 
-                cycles.push_back(cycle);
+                area += cycle.back().x * cycle.front().y - cycle.front().x * cycle.back().y;
+
+                cycles.push_back(std::move(cycle));
+                cycleAreas.push_back(area / 2);
+                cycleBounds.push_back(bounds);
+                cycleRanks.push_back(category);
             }
         }
+
+        fitCycles();
     }
 
-    float ChunkGenerator::scaledPerlin(float x, float y, PerlinNoise &noise) {
-        return (noise.sample<float>(x, y, generator::PERLIN_DEPTH) + 0.25f) * 2.f;
+    std::vector<size_t> ChunkGenerator::cycleOrder() const {
+        // Blocks on the most important roads come first, and the largest of those, as leaving them empty leaves the
+        // biggest holes. Otherwise the order they were found in.
+        std::vector<size_t> order(cycles.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            if (cycleRanks[a] != cycleRanks[b]) return cycleRanks[a] < cycleRanks[b];
+            return std::abs(cycleAreas[a]) > std::abs(cycleAreas[b]);
+        });
+        return order;
+    }
+
+    void ChunkGenerator::fitCycles() {
+        std::vector<std::uint8_t> kept(cycles.size(), false);
+        size_t count = 0;
+        size_t triangles = 0;
+        for (size_t i : cycleOrder()) {
+            size_t cost = GenerationBudget::estimateTriangles(cycles[i], cycleBounds[i]);
+            if (count == budget.cycles || triangles + cost > budget.buildingTriangles) continue;
+
+            kept[i] = true;
+            count++;
+            triangles += cost;
+        }
+
+        if (count == cycles.size()) return;
+        overBudget = true;
+
+        // The rest stay in the order they were found. Moving a cycle onto itself would empty it.
+        size_t next = 0;
+        for (size_t i = 0; i < cycles.size(); i++) {
+            if (!kept[i]) continue;
+
+            if (next != i) {
+                cycles[next] = std::move(cycles[i]);
+                cycleAreas[next] = cycleAreas[i];
+                cycleBounds[next] = cycleBounds[i];
+                cycleRanks[next] = cycleRanks[i];
+            }
+            next++;
+        }
+        cycles.resize(next);
+        cycleAreas.resize(next);
+        cycleBounds.resize(next);
+        cycleRanks.resize(next);
+    }
+
+    float ChunkGenerator::scaledPerlin(float x, float y, const PerlinNoise &noise, const PerlinNoise::Fractal& fractal) {
+        return (noise.sample<float>(x, y, fractal) + 0.25f) * 2.f;
+    }
+
+    void ChunkGenerator::scaledPerlin(const float* xs, const float* ys, size_t n, const PerlinNoise &noise,
+                                      const PerlinNoise::Fractal& fractal, float* out) {
+        noise.sampleN(xs, ys, n, fractal, out);
+        for (size_t i = 0; i < n; i++) {
+            out[i] = (out[i] + 0.25f) * 2.f;
+        }
     }
 }
@@ -2,42 +2,313 @@
 #include "infd/generator/util/helpers.hpp"
 #include "infd/generator/ChunkGenerator.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <imgui.h>
+
 namespace infd::generator {
-    ChunkLoader::ChunkLoader(scene::SceneObject& scene, render::Renderer& renderer, int radius, unsigned int seed, int x, int y) :
-        _radius(radius), _x(x-radius), _y(y-radius), _diameter(radius+radius+1), _seed(seed), _perlinNoise(PerlinNoise(seed)), _renderer(renderer)
+    ChunkLoader::ChunkLoader(scene::SceneObject& scene, render::Renderer& renderer, int radius, unsigned int seed, int x, int y,
+                             const std::filesystem::path& cacheDirectory) :
+        _radius(radius), _x(x-radius), _y(y-radius), _diameter(radius+radius+1), _seed(seed),
+        _focus(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f), _perlinNoise(PerlinNoise(seed)), _renderer(renderer),
+        _workers(seed, _perlinNoise, cacheDirectory.empty() ? nullptr : std::make_shared<ChunkCache>(cacheDirectory, seed), _borders)
     {
-        _chunks.reserve(_diameter * _diameter);
-        for (int x = 0; x < _diameter; x++) {
-            for (int y = 0; y < _diameter; y++) {
-                ChunkGenerator generator(x+_x, y+_y, _seed, _perlinNoise);
-                _chunks.emplace_back(scene, _renderer, generator);
+        _chunks.resize(_diameter * _diameter);
+        _jobs.resize(_diameter * _diameter);
+        _idle.resize(_diameter * _diameter);
+
+        // Submitted in a spiral out from the spawn chunk, which is also the order equally distant chunks start in.
+        int dx = 0;
+        int dy = -1;
+        for (int i = 0, sx = 0, sy = 0; i < _diameter * _diameter; i++) {
+            _jobs[slot(sx + _radius, sy + _radius)] = _workers.submit(sx + x, sy + y, priority(sx + x, sy + y));
+
+            // Turn at the corners of each ring, and one step early on the last side to move out to the next.
+            if (sx == sy || (sx < 0 && sx == -sy) || (sx > 0 && sx == 1 - sy)) {
+                int turn = dx;
+                dx = -dy;
+                dy = turn;
+            }
+            sx += dx;
+            sy += dy;
+        }
+        updateFar();
+
+        // Only the ring around the spawn chunk is attached before the first frame, so nothing falls through the
+        // world, the rest is streamed in by onFrameUpdate. This component isn't attached yet, hence the explicit
+        // parent.
+        auto spawnPending = [this] {
+            for (int x = std::max(_radius - 1, 0); x <= std::min(_radius + 1, _diameter - 1); x++) {
+                for (int y = std::max(_radius - 1, 0); y <= std::min(_radius + 1, _diameter - 1); y++) {
+                    if (_jobs[slot(x, y)]) return true;
+                }
             }
+            return false;
+        };
+        while (spawnPending()) {
+            std::shared_ptr<ChunkJob> job = _workers.wait();
+            if (!job) break;
+            attach(job, scene);
         }
     }
 
     void ChunkLoader::regenAll() {
+        // Reset first, so pending jobs are filed under the same slots they will be attached to.
+        _xOffset = 0;
+        _yOffset = 0;
+
         for (int x = 0; x < _diameter; x++) {
             for (int y = 0; y < _diameter; y++) {
                 replace(x, y, _x, _y);
             }
         }
-
-        _xOffset = 0;
-        _yOffset = 0;
+        updateFar();
     }
 
     void ChunkLoader::replace(int x, int y, int xOffset, int yOffset) {
-        ChunkGenerator generator(x+xOffset, y+yOffset, _seed, _perlinNoise);
-        ChunkPtr& ptr = operator()(x , y);
-        ptr.detach();
-        ptr = ChunkPtr(*this, _renderer, generator);
+        size_t index = slot(x, y);
+
+        _retained.put(std::move(_chunks[index]));
+        _chunks[index] = ChunkPtr();
+
+        if (_jobs[index]) _jobs[index]->cancel();
+        _jobs[index] = nullptr;
+        _idle[index] = 0;
+
+        ChunkPtr retained = _retained.take(x+xOffset, y+yOffset);
+        if (!retained.detached()) {
+            retained.lod(lod(x, y));
+            _chunks[index] = std::move(retained);
+            return;
+        }
+
+        _jobs[index] = _workers.submit(x+xOffset, y+yOffset, priority(x+xOffset, y+yOffset));
     }
 
-    ChunkPtr& ChunkLoader::operator()(int x, int y) {
+    size_t ChunkLoader::slot(int x, int y) const {
         int dx = helpers::positiveModulo(x + _xOffset, _diameter);
         int dy = helpers::positiveModulo(y + _yOffset, _diameter);
 
-        return _chunks[dx * _diameter + dy];
+        return dx * _diameter + dy;
+    }
+
+    unsigned int ChunkLoader::lod(int x, int y) const {
+        int focusX = static_cast<int>(std::floor(_focus.x)) - _x;
+        int focusY = static_cast<int>(std::floor(_focus.y)) - _y;
+
+        size_t ring = std::max(std::abs(x - focusX), std::abs(y - focusY));
+        return TERRAIN_LOD_STRIDES[std::min(ring, std::size(TERRAIN_LOD_STRIDES) - 1)];
+    }
+
+    float ChunkLoader::priority(int x, int y, ChunkJob::Detail detail) const {
+        glm::vec2 offset = glm::vec2(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f) - _focus;
+
+        // Distance to the path from the focus to the end of the lead, so everything along the way comes first.
+        float leadLength2 = glm::dot(_lead, _lead);
+        float along = leadLength2 > 0 ? glm::clamp(glm::dot(offset, _lead) / leadLength2, 0.f, 1.f) : 0.f;
+
+        float priority = glm::length(offset - along * _lead) + STREAMING_DISTANCE_WEIGHT * glm::length(offset);
+
+        // No chunk of the window gets further than the window is across, even counting the weight.
+        if (detail == ChunkJob::Detail::Far) priority += 2.f * static_cast<float>(_diameter);
+        return priority;
+    }
+
+    std::uint64_t ChunkLoader::farKey(int x, int y) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+    }
+
+    void ChunkLoader::updateFar() {
+        auto inWindow = [this](int x, int y) { return x >= 0 && x < _diameter && y >= 0 && y < _diameter; };
+
+        for (auto it = _far.begin(); it != _far.end();) {
+            int x = it->second.x - _x;
+            int y = it->second.y - _y;
+
+            bool inRings = x >= -FAR_CHUNK_RINGS && x < _diameter + FAR_CHUNK_RINGS &&
+                           y >= -FAR_CHUNK_RINGS && y < _diameter + FAR_CHUNK_RINGS;
+            bool replaced = inWindow(x, y) && !_chunks[slot(x, y)].detached();
+            if (inRings && !replaced) {
+                ++it;
+                continue;
+            }
+
+            _farRetained.put(std::move(it->second.chunk));
+            if (it->second.job) it->second.job->cancel();
+            it = _far.erase(it);
+        }
+
+        for (int x = -FAR_CHUNK_RINGS; x < _diameter + FAR_CHUNK_RINGS; x++) {
+            for (int y = -FAR_CHUNK_RINGS; y < _diameter + FAR_CHUNK_RINGS; y++) {
+                if (inWindow(x, y)) continue;
+
+                auto [it, inserted] = _far.try_emplace(farKey(x + _x, y + _y));
+                if (!inserted) continue;
+
+                it->second.x = x + _x;
+                it->second.y = y + _y;
+
+                FarChunkPtr retained = _farRetained.take(x + _x, y + _y);
+                if (!retained.detached()) {
+                    it->second.chunk = std::move(retained);
+                    continue;
+                }
+
+                it->second.job = _workers.submit(x + _x, y + _y, priority(x + _x, y + _y, ChunkJob::Detail::Far),
+                                                 ChunkJob::Detail::Far);
+            }
+        }
+    }
+
+    void ChunkLoader::dropFar(int x, int y) {
+        auto it = _far.find(farKey(x, y));
+        if (it == _far.end()) return;
+
+        _farRetained.put(std::move(it->second.chunk));
+        if (it->second.job) it->second.job->cancel();
+        _far.erase(it);
+    }
+
+    void ChunkLoader::updateLods() {
+        for (int x = 0; x < _diameter; x++) {
+            for (int y = 0; y < _diameter; y++) {
+                _chunks[slot(x, y)].lod(lod(x, y));
+            }
+        }
+    }
+
+    void ChunkLoader::updateCollision(float deltaTime) {
+        std::vector<std::uint8_t> near(_chunks.size(), false);
+
+        auto* physics = scene().findComponentInRoots<scene::physics::PhysicsContext>();
+        if (physics) {
+            glm::vec3 scale = transform().localScale();
+            physics->forEachDynamicBounds([&](glm::vec3 min, glm::vec3 max) {
+                int minX = std::max(static_cast<int>(std::floor(min.x / scale.x - COLLISION_MARGIN)) - _x, 0);
+                int minY = std::max(static_cast<int>(std::floor(min.z / scale.z - COLLISION_MARGIN)) - _y, 0);
+                int maxX = std::min(static_cast<int>(std::floor(max.x / scale.x + COLLISION_MARGIN)) - _x, _diameter - 1);
+                int maxY = std::min(static_cast<int>(std::floor(max.z / scale.z + COLLISION_MARGIN)) - _y, _diameter - 1);
+
+                for (int x = minX; x <= maxX; x++) {
+                    for (int y = minY; y <= maxY; y++) {
+                        near[slot(x, y)] = true;
+                    }
+                }
+            });
+        }
+
+        for (size_t i = 0; i < _chunks.size(); i++) {
+            _idle[i] = near[i] ? 0 : _idle[i] + deltaTime;
+
+            if (near[i]) {
+                _chunks[i].colliding(true);
+            } else if (_idle[i] > COLLISION_LINGER) {
+                _chunks[i].colliding(false);
+            }
+        }
+    }
+
+    ChunkPtr& ChunkLoader::operator()(int x, int y) {
+        return _chunks[slot(x, y)];
+    }
+
+    void ChunkLoader::follow(const scene::physics::RigidBody* body) noexcept {
+        _following = body;
+    }
+
+    const scene::physics::RigidBody* ChunkLoader::following() const noexcept {
+        return _following;
+    }
+
+    void ChunkLoader::attach(std::shared_ptr<ChunkJob>& job, scene::SceneObject& parent) {
+        if (job->cancelled) return;
+        job->rethrow();
+
+        if (job->detail == ChunkJob::Detail::Far) {
+            auto it = _far.find(farKey(job->x, job->y));
+            if (it == _far.end() || it->second.job != job) return;
+
+            it->second.chunk = FarChunkPtr(parent, _renderer, *job->far);
+            it->second.job = nullptr;
+            return;
+        }
+
+        int x = job->x - _x;
+        int y = job->y - _y;
+        size_t index = slot(x, y);
+
+        // The slot may have been handed to another chunk since this job was submitted.
+        if (_jobs[index] != job) return;
+
+        // At the stride for where the centre is now, which may have moved on while it was generating.
+        _chunks[index] = ChunkPtr(parent, _renderer, _terrainGrids, *job->data, lod(x, y));
+        _jobs[index] = nullptr;
+
+        // Whatever was standing in for it can go now.
+        dropFar(job->x, job->y);
+    }
+
+    void ChunkLoader::upload(Duration budget) {
+        auto start = std::chrono::steady_clock::now();
+
+        do {
+            std::shared_ptr<ChunkJob> job = _workers.poll();
+            if (!job) break;
+
+            attach(job, sceneObject());
+        } while (std::chrono::steady_clock::now() - start < budget);
+
+        _workers.step(budget - (std::chrono::steady_clock::now() - start));
+    }
+
+    void ChunkLoader::flush() {
+        while (std::shared_ptr<ChunkJob> job = _workers.wait()) {
+            attach(job, sceneObject());
+        }
+    }
+
+    float ChunkLoader::heightAt(float worldX, float worldZ) const {
+        glm::vec3 scale = transform().localScale();
+
+        float x = worldX / scale.x;
+        float y = worldZ / scale.z;
+
+        int chunkX = static_cast<int>(std::floor(x));
+        int chunkY = static_cast<int>(std::floor(y));
+
+        float localX = x - static_cast<float>(chunkX);
+        float localY = y - static_cast<float>(chunkY);
+
+        int dx = chunkX - _x;
+        int dy = chunkY - _y;
+
+        if (dx >= 0 && dx < _diameter && dy >= 0 && dy < _diameter) {
+            if (const Heightfield* heightfield = _chunks[slot(dx, dy)].heightfield()) {
+                return heightfield->sample(localX, localY) * scale.y;
+            }
+        }
+
+        return Heightfield::sample(chunkX, chunkY, TERRAIN_RESOLUTION, _perlinNoise, localX, localY) * scale.y;
+    }
+
+    float ChunkLoader::horizon() const {
+        glm::vec3 scale = transform().localScale();
+        // The focus may be anywhere in the centre chunk.
+        float reach = static_cast<float>(_radius + FAR_CHUNK_RINGS + 1);
+        return glm::length(glm::vec2(reach * scale.x, reach * scale.z));
+    }
+
+    ChunkLoader::Duration ChunkLoader::uploadBudget() const {
+        return _uploadBudget;
+    }
+
+    void ChunkLoader::uploadBudget(Duration budget) {
+        _uploadBudget = budget;
     }
 
     void ChunkLoader::move(int x, int y) {
@@ -84,25 +355,81 @@ namespace infd::generator {
                 replace(ix, iy, xPrev+dx, yPrev+dy);
             }
         }
+
+        updateLods();
+        updateFar();
     }
 
     void ChunkLoader::detachAll() {
         for (ChunkPtr& ptr : _chunks) {
             ptr.detach();
         }
+        for (std::shared_ptr<ChunkJob>& job : _jobs) {
+            if (job) job->cancel();
+            job = nullptr;
+        }
+        for (auto& [key, far] : _far) {
+            far.chunk.detach();
+            if (far.job) far.job->cancel();
+        }
+        _far.clear();
+        _retained.clear();
+        _farRetained.clear();
     }
 
     void ChunkLoader::center(float x, float y) {
         int xTransform = std::floor(x) - _radius;
         int yTransform = std::floor(y) - _radius;
-        if (xTransform != _x || yTransform != y) {
+        if (xTransform != _x || yTransform != _y) {
             move(xTransform, yTransform);
         }
     }
 
+    void ChunkLoader::gui() {
+        ImGui::Text("Parked chunks: %zu (%.1f MiB)", _retained.size(), static_cast<double>(_retained.bytes()) / (1 << 20));
+        ImGui::Text("Chunk reuse: %zu hits, %zu misses", _retained.hits(), _retained.misses());
+        ImGui::Text("Shared borders: %zu (%zu hits, %zu misses)", _borders->size(), _borders->hits(), _borders->misses());
+
+        size_t colliding = std::count_if(_chunks.begin(), _chunks.end(), [](const ChunkPtr& chunk) { return chunk.colliding(); });
+        ImGui::Text("Colliding chunks: %zu of %zu", colliding, _chunks.size());
+
+        size_t farBytes = 0;
+        size_t farLoaded = 0;
+        for (const auto& [key, far] : _far) {
+            farBytes += far.chunk.bytes();
+            farLoaded += !far.chunk.detached();
+        }
+        ImGui::Text("Far chunks: %zu of %zu (%.1f MiB)", farLoaded, _far.size(), static_cast<double>(farBytes) / (1 << 20));
+        ImGui::Text("Parked far chunks: %zu (%.1f MiB)", _farRetained.size(), static_cast<double>(_farRetained.bytes()) / (1 << 20));
+        ImGui::Text("Far chunk reuse: %zu hits, %zu misses", _farRetained.hits(), _farRetained.misses());
+    }
+
     void ChunkLoader::onFrameUpdate() {
-        glm::vec3 cameraPosition = _renderer._camera->transform().globalPosition();
+        glm::vec3 position = _renderer._camera->transform().globalPosition();
+        glm::vec3 velocity(0);
+        if (_following) {
+            position = _following->transform().globalPosition();
+            velocity = _following->linearVelocity();
+        }
+
         glm::vec3 scale = transform().localScale();
-        center(cameraPosition.x / scale.x, cameraPosition.z / scale.z);
+        _focus = glm::vec2(position.x / scale.x, position.z / scale.z);
+        _lead = glm::vec2(velocity.x / scale.x, velocity.z / scale.z) * STREAMING_LOOKAHEAD;
+
+        // Always keep the ring around the focus, however fast it's going.
+        float reach = static_cast<float>(std::max(_radius - 1, 0));
+        float leadLength = glm::length(_lead);
+        if (leadLength > reach) _lead *= reach / leadLength;
+
+        center(_focus.x + _lead.x, _focus.y + _lead.y);
+        // The focus can cross into another chunk without the window moving.
+        updateLods();
+
+        _workers.reprioritize([this](const ChunkJob& job) { return priority(job.x, job.y, job.detail); });
+        upload(_uploadBudget);
+    }
+
+    void ChunkLoader::onPhysicsUpdate() {
+        updateCollision(std::chrono::duration_cast<std::chrono::duration<float>>(physicsDeltaTime()).count());
     }
-}
\ No newline at end of file
+}
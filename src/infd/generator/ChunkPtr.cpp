@@ -1,63 +1,190 @@
 #include <infd/generator/ChunkPtr.hpp>
-#include <infd/generator/meshbuilding/PerlinMesh.hpp>
-#include <infd/generator/meshbuilding/RoadMeshBuilder.hpp>
 #include <infd/render/RenderComponent.hpp>
+#include <infd/generator/meshbuilding/PerlinMesh.hpp>
 #include <infd/scene/physics/BvhTriangleMeshShape.hpp>
+#include <infd/scene/physics/HeightfieldShape.hpp>
 #include <infd/scene/physics/physics.hpp>
 #include <infd/Wavefront.hpp>
 
 #include <infd/debug/glm.hpp>
 #include <iostream>
-#include "infd/generator/meshbuilding/BuildingMeshBuilder.hpp"
 
 namespace infd::generator {
-    ChunkPtr::ChunkPtr(scene::Component &parent, render::Renderer &renderer, ChunkGenerator &generator) :
-            ChunkPtr(parent.sceneObject(), renderer, generator) {}
+    namespace {
+        size_t renderBytes(size_t vertexCount, size_t indexCount) {
+            return vertexCount * sizeof(MeshVertex) + indexCount * sizeof(unsigned int);
+        }
 
-    ChunkPtr::ChunkPtr(scene::SceneObject& scene, render::Renderer& renderer, ChunkGenerator& generator) {
-        scene::SceneObject& chunkSceneObject = scene.addChild((std::stringstream() << "Chunk: " << generator.x << ", "<< generator.y).str());
+        // Calls fn on object and everything under it.
+        template <typename Fn>
+        void visitAll(scene::SceneObject& object, Fn&& fn) {
+            fn(object);
+            object.visitAllChildren(fn);
+        }
+    }
 
-        auto [perlin_mesh, perlin_collision_mesh] = meshbuilding::generatePerlinMesh(generator.x, generator.y, generator.perlinNoise);
-        auto [road_mesh, road_collision_mesh] = meshbuilding::RoadMeshBuilder(generator).build();
+    ChunkPtr::ChunkPtr(scene::Component &parent, render::Renderer &renderer, TerrainGrids& grids, ChunkFile &file,
+                       unsigned int stride) :
+            ChunkPtr(parent.sceneObject(), renderer, grids, file, stride) {}
 
-        chunkSceneObject.transform().localPosition({generator.x, 0, generator.y});
+    ChunkPtr::ChunkPtr(scene::SceneObject& scene, render::Renderer& renderer, TerrainGrids& grids, ChunkFile& file,
+                       unsigned int stride) :
+            _x(file.x), _y(file.y) {
+        scene::SceneObject& chunkSceneObject = scene.addChild((std::stringstream() << "Chunk: " << file.x << ", "<< file.y).str());
 
-        chunkSceneObject.emplaceComponent<render::RenderComponent>(renderer, std::move(perlin_mesh));
+        chunkSceneObject.transform().localPosition({file.x, 0, file.y});
 
-        chunkSceneObject.emplaceComponent<scene::physics::BvhTriangleMeshShape>(std::move(perlin_collision_mesh));
-        chunkSceneObject.emplaceComponent<scene::physics::RigidBody>().mass(0);
+        _terrain = &chunkSceneObject.emplaceComponent<render::RenderComponent>(renderer, grids.get(stride));
+        _terrain->material.flat_shading = true;
+        _terrain->displacement.heights = TerrainGrids::heights(file.heightfield);
+        _terrain->displacement.skirt_depth = meshbuilding::terrainSkirtDepth(file.heightfield);
+        _grids = &grids;
+        _lod = stride;
 
-        auto& roadSceneObject = chunkSceneObject.addChild((std::stringstream() << "Roads: " << generator.x << ", "<< generator.y).str());
+        auto& roadSceneObject = chunkSceneObject.addChild((std::stringstream() << "Roads: " << file.x << ", "<< file.y).str());
 
-        auto& roadObj = roadSceneObject.emplaceComponent<render::RenderComponent>(renderer, std::move(road_mesh));
+        auto& roadObj = roadSceneObject.emplaceComponent<render::RenderComponent>(renderer, file.roads.build());
 
-        roadObj.material.colour = glm::vec3(0.5);
-        
-        roadSceneObject.emplaceComponent<scene::physics::BvhTriangleMeshShape>(std::move(road_collision_mesh));
-        roadSceneObject.emplaceComponent<scene::physics::RigidBody>().mass(0);
+        roadObj.material.colour = file.roads.colour;
 
-        helpers::RandomType random(generator.seed);
+        if (file.roads.collision) _collisionMeshes.push_back({&roadSceneObject, std::move(file.roads.collision), file.roads.bvh});
 
-        for (Clipper2Lib::PathD& path : generator.cycles) {
-            auto [building_mesh, building_collision_mesh] = meshbuilding::BuildingMeshBuilder(generator, path, random).build();
+        _bytes = file.size() + file.heightfield.samples().size() * sizeof(float) +
+                renderBytes(file.roads.vertexCount, file.roads.indexCount);
 
-            auto& buildingSceneObject = chunkSceneObject.addChild((std::stringstream() << "Building: " << &path).str());
+        for (ChunkFile::Mesh& building : file.buildings) {
+            auto& buildingSceneObject = chunkSceneObject.addChild((std::stringstream() << "Building: " << &building).str());
 
-            auto& buildingObj = roadSceneObject.emplaceComponent<render::RenderComponent>(renderer, std::move(building_mesh));
+            auto& buildingObj = roadSceneObject.emplaceComponent<render::RenderComponent>(renderer, building.build());
 
-            buildingObj.material.colour = glm::vec3(buildingColourDist(random), buildingColourDist(random), buildingColourDist(random));
+            buildingObj.material.colour = building.colour;
 
-            if (building_collision_mesh->getNumTriangles() > 0) {
-                buildingSceneObject.emplaceComponent<scene::physics::BvhTriangleMeshShape>(std::move(building_collision_mesh));
-                buildingSceneObject.emplaceComponent<scene::physics::RigidBody>().mass(0);
-            }
+            if (building.collision) _collisionMeshes.push_back({&buildingSceneObject, std::move(building.collision), building.bvh});
+            _bytes += renderBytes(building.vertexCount, building.indexCount);
         }
 
+        _heightfield = std::move(file.heightfield);
+        _storage = file.storage();
+        _borders = std::move(file.borders);
+
         _chunkScenePointer = &chunkSceneObject;
+        _detached = false;
+    }
+
+    bool ChunkPtr::detached() const {
+        return _detached;
+    }
+
+    bool ChunkPtr::parked() const {
+        return _parked;
+    }
+
+    int ChunkPtr::x() const {
+        return _x;
+    }
+
+    int ChunkPtr::y() const {
+        return _y;
+    }
+
+    size_t ChunkPtr::bytes() const {
+        return _bytes;
+    }
+
+    const Heightfield* ChunkPtr::heightfield() const {
+        return _detached ? nullptr : &_heightfield;
+    }
+
+    unsigned int ChunkPtr::lod() const {
+        return _lod;
+    }
+
+    void ChunkPtr::lod(unsigned int stride) {
+        if (_detached || stride == _lod) return;
+
+        _terrain->mesh = _grids->get(stride);
+        _lod = stride;
+    }
+
+    void ChunkPtr::buildCollision() {
+        // Bullet centres heightfields, so the collision sits on its own object in the middle of the chunk.
+        auto resolution = static_cast<int>(_heightfield.resolution());
+
+        auto& terrainCollisionObject = _chunkScenePointer->addChild("Terrain Collision");
+        auto& terrainShape = terrainCollisionObject.emplaceComponent<scene::physics::HeightfieldShape>(
+                _heightfield.heights(), resolution + 1, resolution + 1, 1.f / static_cast<float>(resolution)
+        );
+        terrainCollisionObject.transform().localPosition(terrainShape.centre());
+        terrainCollisionObject.emplaceComponent<scene::physics::RigidBody>().mass(0);
+
+        for (CollisionMesh& mesh : _collisionMeshes) {
+            mesh.object->emplaceComponent<scene::physics::BvhTriangleMeshShape>(std::move(mesh.triangles), *mesh.bvh, _storage);
+            mesh.object->emplaceComponent<scene::physics::RigidBody>().mass(0);
+        }
+
+        // The shapes hold on to the storage themselves from here.
+        _collisionMeshes.clear();
+        _storage = nullptr;
+        _collisionBuilt = true;
+    }
+
+    bool ChunkPtr::colliding() const {
+        return _colliding;
+    }
+
+    void ChunkPtr::colliding(bool value) {
+        if (_detached || value == _colliding) return;
+
+        if (value && !_collisionBuilt) {
+            buildCollision();
+        } else {
+            visitAll(*_chunkScenePointer, [value](scene::SceneObject& object) {
+                for (scene::physics::RigidBody& body : object.getComponentsView<scene::physics::RigidBody>()) {
+                    body.simulated(value);
+                }
+            });
+        }
+
+        _colliding = value;
+    }
+
+    void ChunkPtr::park() {
+        if (_detached || _parked) return;
+
+        colliding(false);
+        visitAll(*_chunkScenePointer, [](scene::SceneObject& object) {
+            for (render::RenderComponent& render : object.getComponentsView<render::RenderComponent>()) {
+                render.visible(false);
+            }
+        });
+        _parked = true;
+    }
+
+    void ChunkPtr::unpark() {
+        if (_detached || !_parked) return;
+
+        visitAll(*_chunkScenePointer, [](scene::SceneObject& object) {
+            for (render::RenderComponent& render : object.getComponentsView<render::RenderComponent>()) {
+                render.visible(true);
+            }
+        });
+        _parked = false;
     }
 
     void ChunkPtr::detach() {
+        if (_detached) return;
+
         (void)_chunkScenePointer->removeFromParent();
+        _chunkScenePointer = nullptr;
+        _heightfield = {};
+        _borders = {};
+        _terrain = nullptr;
+        _grids = nullptr;
+        _collisionMeshes.clear();
+        _storage = nullptr;
         _detached = true;
+        _parked = false;
+        _colliding = false;
+        _collisionBuilt = false;
     }
 }
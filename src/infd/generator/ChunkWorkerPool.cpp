@@ -0,0 +1,201 @@
+#include "infd/generator/ChunkWorkerPool.hpp"
+#include "infd/generator/util/parallel.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace infd::generator {
+    ChunkWorkerPool::ChunkWorkerPool(unsigned int seed, PerlinNoise& perlinNoise, std::shared_ptr<const ChunkCache> cache,
+                                     std::shared_ptr<BorderCache> borders, unsigned int threadCount) :
+        _seed(seed), _perlinNoise(perlinNoise), _cache(std::move(cache)), _borders(std::move(borders)) {
+        _workers.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; i++) {
+            _workers.emplace_back(&ChunkWorkerPool::work, this);
+        }
+    }
+
+    ChunkWorkerPool::~ChunkWorkerPool() {
+        {
+            std::lock_guard lock(_mutex);
+            _stopping = true;
+            for (std::shared_ptr<ChunkJob>& job : _queue) {
+                job->cancel();
+            }
+            _queue.clear();
+            _current = nullptr;
+        }
+        _queueCondition.notify_all();
+
+        for (std::thread& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    unsigned int ChunkWorkerPool::defaultThreadCount() {
+        // Leave a core for the render thread, which on a single core has to do the generating too.
+        unsigned int hardware = std::thread::hardware_concurrency();
+        return hardware == 0 ? 1 : hardware - 1;
+    }
+
+    bool ChunkWorkerPool::startsAfter(const std::shared_ptr<ChunkJob>& a, const std::shared_ptr<ChunkJob>& b) {
+        if (a->priority != b->priority) return a->priority > b->priority;
+        return a->_sequence > b->_sequence;
+    }
+
+    std::shared_ptr<ChunkJob> ChunkWorkerPool::submit(int x, int y, float priority, ChunkJob::Detail detail) {
+        auto job = std::make_shared<ChunkJob>(x, y, detail);
+        job->priority = priority;
+        {
+            std::lock_guard lock(_mutex);
+            job->_sequence = _submitted++;
+            _queue.push_back(job);
+            std::push_heap(_queue.begin(), _queue.end(), startsAfter);
+        }
+        _queueCondition.notify_one();
+        return job;
+    }
+
+    std::shared_ptr<ChunkJob> ChunkWorkerPool::popCompleted() {
+        std::shared_ptr<ChunkJob> job = std::move(_completed.front());
+        _completed.pop_front();
+        return job;
+    }
+
+    std::shared_ptr<ChunkJob> ChunkWorkerPool::poll() {
+        std::lock_guard lock(_mutex);
+        if (_completed.empty()) return nullptr;
+
+        return popCompleted();
+    }
+
+    std::shared_ptr<ChunkJob> ChunkWorkerPool::wait() {
+        if (_workers.empty()) {
+            while (true) {
+                {
+                    std::lock_guard lock(_mutex);
+                    if (!_completed.empty()) return popCompleted();
+                    if (_queue.empty() && !_current) return nullptr;
+                }
+                step(Duration::zero());
+            }
+        }
+
+        std::unique_lock lock(_mutex);
+        _completedCondition.wait(lock, [this] {
+            return !_completed.empty() || (_queue.empty() && _running == 0);
+        });
+        if (_completed.empty()) return nullptr;
+
+        return popCompleted();
+    }
+
+    void ChunkWorkerPool::step(Duration budget) {
+        if (!_workers.empty()) return;
+
+        auto start = std::chrono::steady_clock::now();
+        do {
+            if (!_current) {
+                std::lock_guard lock(_mutex);
+                while (!_queue.empty() && !_current) {
+                    std::pop_heap(_queue.begin(), _queue.end(), startsAfter);
+                    if (!_queue.back()->cancelled) _current = std::move(_queue.back());
+                    _queue.pop_back();
+                }
+                if (!_current) return;
+
+                _current->_steps = generate(*_current, GENERATION_BATCH);
+            }
+
+            bool more = false;
+            try {
+                more = !_current->cancelled && _current->_steps.resume();
+            } catch (...) {
+                _current->_exception = std::current_exception();
+            }
+            if (more) continue;
+
+            // Drops whatever a cancelled job had generated so far along with its steps.
+            _current->_steps = {};
+            std::lock_guard lock(_mutex);
+            if (!_current->cancelled) _completed.push_back(std::move(_current));
+            _current = nullptr;
+        } while (std::chrono::steady_clock::now() - start < budget);
+    }
+
+    size_t ChunkWorkerPool::pending() const {
+        std::lock_guard lock(_mutex);
+        return _queue.size() + _running + _completed.size() + (_current ? 1 : 0);
+    }
+
+    void ChunkWorkerPool::work() {
+        unsigned int hardware = std::max(std::thread::hardware_concurrency(), 1u);
+
+        while (true) {
+            std::shared_ptr<ChunkJob> job;
+            unsigned int threads;
+            {
+                std::unique_lock lock(_mutex);
+                _queueCondition.wait(lock, [this] { return _stopping || !_queue.empty(); });
+                if (_stopping) return;
+
+                std::pop_heap(_queue.begin(), _queue.end(), startsAfter);
+                job = std::move(_queue.back());
+                _queue.pop_back();
+
+                if (job->cancelled) {
+                    if (_queue.empty() && _running == 0) _completedCondition.notify_all();
+                    continue;
+                }
+                _running++;
+
+                // Chunks already run side by side on the workers, so only split the cores left idle between them
+                // between the items inside this one, rather than starting a full team on every worker.
+                size_t busy = _running + _queue.size();
+                threads = static_cast<unsigned int>(std::max<size_t>(1, hardware / busy));
+            }
+            helpers::parallelThreads(threads);
+
+            try {
+                // Other jobs run alongside rather than between the steps, so there's no point pausing.
+                generate(*job, std::numeric_limits<size_t>::max()).run();
+            } catch (...) {
+                job->_exception = std::current_exception();
+            }
+
+            {
+                std::lock_guard lock(_mutex);
+                _running--;
+                // Cancelled jobs are dropped here; their owner has already stopped waiting for them.
+                if (!job->cancelled) _completed.push_back(std::move(job));
+            }
+            _completedCondition.notify_all();
+        }
+    }
+
+    helpers::Steps ChunkWorkerPool::generate(ChunkJob& job, size_t batch) const {
+        if (job.detail == ChunkJob::Detail::Far) {
+            auto far = std::make_unique<FarChunkData>(job.x, job.y, _seed, _perlinNoise, _borders.get(), helpers::deferred);
+            co_yield far->generate(job.cancelled, batch);
+            if (!job.cancelled) job.far = std::move(far);
+            co_return;
+        }
+
+        job.data = _cache ? _cache->load(job.x, job.y) : nullptr;
+        if (job.data) co_return;
+
+        // Fresh chunks go through their serialised form too, so they're attached exactly like cached ones.
+        ChunkData data(job.x, job.y, _seed, _perlinNoise, _borders.get(), helpers::deferred);
+        co_yield data.generate(job.cancelled, nullptr, batch);
+        if (job.cancelled) co_return;
+
+        ChunkFile::Buffer bytes;
+        co_yield ChunkFile::serialize(data, bytes, batch);
+        if (_cache) _cache->store(job.x, job.y, bytes);
+
+        std::unique_ptr<ChunkFile> file = ChunkFile::open(std::move(bytes));
+        if (!file) throw std::logic_error("Freshly serialised chunk could not be read back");
+        file->borders = data.generator.borders;
+        job.data = std::move(file);
+    }
+}
@@ -0,0 +1,80 @@
+#include "infd/generator/FarChunkData.hpp"
+#include "infd/generator/ChunkData.hpp"
+#include "infd/generator/ChunkGenerator.hpp"
+#include "infd/generator/meshbuilding/BlockMesh.hpp"
+#include "infd/generator/meshbuilding/BuildingMeshBuilder.hpp"
+#include "infd/generator/meshbuilding/PerlinMesh.hpp"
+#include "infd/generator/util/parallel.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace infd::generator {
+    FarChunkData::FarChunkData(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, const std::atomic<bool>& cancelled,
+                               BorderCache* borderCache) :
+        FarChunkData(x, y, seed, perlinNoise, borderCache, helpers::deferred) {
+        generate(cancelled, std::numeric_limits<size_t>::max()).run();
+    }
+
+    FarChunkData::FarChunkData(int x, int y, unsigned int seed, PerlinNoise& perlinNoise, BorderCache* borderCache,
+                               helpers::Deferred) :
+        _generator(std::make_unique<ChunkGenerator>(x, y, seed, perlinNoise, borderCache, helpers::deferred)), x(x), y(y) {}
+
+    helpers::Steps FarChunkData::generate(const std::atomic<bool>& cancelled, size_t batch) {
+        ChunkGenerator& generator = *_generator;
+        co_yield generator.generate();
+        if (cancelled) co_return;
+
+        std::vector<std::optional<meshbuilding::Block>> reduced(generator.cycles.size());
+        std::vector<glm::vec3> colours(generator.cycles.size());
+
+        for (size_t begin = 0, count; begin < reduced.size(); begin += count) {
+            if (cancelled) co_return;
+            count = std::min(batch, reduced.size() - begin);
+
+            // The same streams ChunkData builds from, so each block stands as tall as the building it replaces.
+            helpers::parallelFor(count, [&](size_t j) {
+                if (cancelled) return;
+
+                size_t i = begin + j;
+                helpers::RandomType random = ChunkData::buildingRandom(generator, i, colours[i]);
+                reduced[i] = meshbuilding::BuildingMeshBuilder(generator, generator.cycles[i], random).block(FAR_BLOCK_TOLERANCE);
+            });
+            co_yield helpers::pause;
+        }
+        if (cancelled) co_return;
+
+        std::vector<meshbuilding::Block> built;
+        built.reserve(reduced.size());
+        for (size_t i = 0; i < reduced.size(); i++) {
+            if (!reduced[i]) continue;
+            built.push_back(std::move(*reduced[i]));
+            colour += colours[i];
+        }
+        if (!built.empty()) colour /= static_cast<float>(built.size());
+
+        unsigned int coarsest = *std::max_element(std::begin(TERRAIN_LOD_STRIDES), std::end(TERRAIN_LOD_STRIDES));
+        mesh = meshbuilding::generateTerrainGrid(generator.heightfield.resolution(), coarsest);
+        meshbuilding::displaceTerrainGrid(mesh, generator.heightfield, meshbuilding::terrainSkirtDepth(generator.heightfield));
+
+        GLMeshBuilder blocks = meshbuilding::generateBlockMesh(built);
+        auto first = static_cast<unsigned int>(mesh.vertices.size());
+        for (MeshVertex& vertex : blocks.vertices) {
+            vertex.uv = glm::vec2(1, 0);
+            mesh.vertices.push_back(vertex);
+        }
+        for (unsigned int index : blocks.indices) {
+            mesh.indices.push_back(first + index);
+        }
+
+        borders = generator.borders;
+        _generator = nullptr;
+    }
+
+    size_t FarChunkData::bytes() const {
+        return mesh.vertices.size() * sizeof(MeshVertex) + mesh.indices.size() * sizeof(unsigned int);
+    }
+}
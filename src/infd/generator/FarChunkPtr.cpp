@@ -0,0 +1,72 @@
+#include <infd/generator/FarChunkPtr.hpp>
+#include <infd/render/RenderComponent.hpp>
+
+#include <sstream>
+
+namespace infd::generator {
+    FarChunkPtr::FarChunkPtr(scene::SceneObject& scene, render::Renderer& renderer, FarChunkData& data) :
+            _x(data.x), _y(data.y) {
+        scene::SceneObject& chunkSceneObject = scene.addChild((std::stringstream() << "Far Chunk: " << data.x << ", " << data.y).str());
+
+        chunkSceneObject.transform().localPosition({data.x, 0, data.y});
+
+        auto& impostor = chunkSceneObject.emplaceComponent<render::RenderComponent>(renderer, data.mesh.build());
+        impostor.material.secondary_colour = data.colour;
+        impostor.material.flat_shading = true;
+        impostor.material.casts_shadows = false;
+
+        _bytes = data.bytes();
+        _borders = std::move(data.borders);
+
+        _chunkScenePointer = &chunkSceneObject;
+        _detached = false;
+    }
+
+    bool FarChunkPtr::detached() const {
+        return _detached;
+    }
+
+    bool FarChunkPtr::parked() const {
+        return _parked;
+    }
+
+    int FarChunkPtr::x() const {
+        return _x;
+    }
+
+    int FarChunkPtr::y() const {
+        return _y;
+    }
+
+    size_t FarChunkPtr::bytes() const {
+        return _bytes;
+    }
+
+    void FarChunkPtr::park() {
+        if (_detached || _parked) return;
+
+        for (render::RenderComponent& render : _chunkScenePointer->getComponentsView<render::RenderComponent>()) {
+            render.visible(false);
+        }
+        _parked = true;
+    }
+
+    void FarChunkPtr::unpark() {
+        if (_detached || !_parked) return;
+
+        for (render::RenderComponent& render : _chunkScenePointer->getComponentsView<render::RenderComponent>()) {
+            render.visible(true);
+        }
+        _parked = false;
+    }
+
+    void FarChunkPtr::detach() {
+        if (_detached) return;
+
+        (void)_chunkScenePointer->removeFromParent();
+        _chunkScenePointer = nullptr;
+        _borders = {};
+        _detached = true;
+        _parked = false;
+    }
+}
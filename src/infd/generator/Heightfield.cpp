@@ -0,0 +1,116 @@
+#include "infd/generator/Heightfield.hpp"
+#include "infd/generator/ChunkGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <glm/geometric.hpp>
+
+namespace infd::generator {
+    Heightfield::Heightfield(int x, int y, unsigned int resolution, const PerlinNoise& noise) :
+        _resolution(resolution), _stride(resolution + 3), _heights(_stride * _stride) {
+        std::vector<float> xs(_heights.size());
+        std::vector<float> ys(_heights.size());
+
+        for (unsigned int j = 0; j < _stride; j++) {
+            for (unsigned int i = 0; i < _stride; i++) {
+                xs[j * _stride + i] = coordinate(x, i, resolution);
+                ys[j * _stride + i] = coordinate(y, j, resolution);
+            }
+        }
+
+        ChunkGenerator::scaledPerlin(xs.data(), ys.data(), _heights.size(), noise, TERRAIN_NOISE, _heights.data());
+
+        for (float& height : _heights) {
+            height *= PERLIN_TERRAIN_FACTOR;
+        }
+    }
+
+    Heightfield::Heightfield(unsigned int resolution, std::vector<float> samples) :
+        _resolution(resolution), _stride(resolution + 3), _heights(std::move(samples)) {}
+
+    float Heightfield::coordinate(int chunk, unsigned int i, unsigned int resolution) {
+        // Dividing rather than stepping keeps the chunk edges exact.
+        return static_cast<float>(chunk) + static_cast<float>(static_cast<int>(i) - 1) / static_cast<float>(resolution);
+    }
+
+    Heightfield::Cell Heightfield::locate(float x, float y, unsigned int resolution) {
+        unsigned int stride = resolution + 3;
+        auto last = static_cast<float>(stride - 1);
+
+        float gridX = std::clamp(x * static_cast<float>(resolution) + 1, 0.f, last);
+        float gridY = std::clamp(y * static_cast<float>(resolution) + 1, 0.f, last);
+
+        unsigned int i = std::min(static_cast<unsigned int>(gridX), stride - 2);
+        unsigned int j = std::min(static_cast<unsigned int>(gridY), stride - 2);
+
+        return {i, j, gridX - static_cast<float>(i), gridY - static_cast<float>(j)};
+    }
+
+    float Heightfield::interpolate(float lowerLeft, float lowerRight, float upperLeft, float upperRight, const Cell& cell) {
+        float lower = lowerLeft + (lowerRight - lowerLeft) * cell.tx;
+        float upper = upperLeft + (upperRight - upperLeft) * cell.tx;
+
+        return lower + (upper - lower) * cell.ty;
+    }
+
+    unsigned int Heightfield::resolution() const {
+        return _resolution;
+    }
+
+    float Heightfield::vertex(int i, int j) const {
+        return _heights[(j + 1) * _stride + (i + 1)];
+    }
+
+    std::vector<float> Heightfield::heights() const {
+        std::vector<float> interior;
+        interior.reserve((_resolution + 1) * (_resolution + 1));
+
+        for (unsigned int j = 1; j <= _resolution + 1; j++) {
+            auto row = _heights.begin() + j * _stride;
+            interior.insert(interior.end(), row + 1, row + _resolution + 2);
+        }
+
+        return interior;
+    }
+
+    const std::vector<float>& Heightfield::samples() const {
+        return _heights;
+    }
+
+    glm::vec3 Heightfield::normal(int i, int j) const {
+        return glm::normalize(glm::vec3(
+                vertex(i - 1, j) - vertex(i + 1, j),
+                2.f / static_cast<float>(_resolution),
+                vertex(i, j - 1) - vertex(i, j + 1)
+        ));
+    }
+
+    float Heightfield::sample(float x, float y) const {
+        Cell cell = locate(x, y, _resolution);
+        const float* row = _heights.data() + cell.j * _stride + cell.i;
+
+        return interpolate(row[0], row[1], row[_stride], row[_stride + 1], cell);
+    }
+
+    float Heightfield::sample(int chunkX, int chunkY, unsigned int resolution, const PerlinNoise& noise,
+                              float x, float y) {
+        Cell cell = locate(x, y, resolution);
+
+        // Lower left, lower right, upper left and upper right, as in the grid.
+        float xs[4];
+        float ys[4];
+        for (unsigned int corner = 0; corner < 4; corner++) {
+            xs[corner] = coordinate(chunkX, cell.i + corner % 2, resolution);
+            ys[corner] = coordinate(chunkY, cell.j + corner / 2, resolution);
+        }
+
+        float heights[4];
+        ChunkGenerator::scaledPerlin(xs, ys, 4, noise, TERRAIN_NOISE, heights);
+        for (float& height : heights) {
+            height *= PERLIN_TERRAIN_FACTOR;
+        }
+
+        return interpolate(heights[0], heights[1], heights[2], heights[3], cell);
+    }
+}
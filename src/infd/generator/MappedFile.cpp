@@ -0,0 +1,76 @@
+#include "infd/generator/MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace infd::generator {
+    MappedFile::MappedFile(std::byte* data, size_t size) : _data(data), _size(size) {}
+
+#ifdef _WIN32
+    std::unique_ptr<MappedFile> MappedFile::open(const std::filesystem::path& path) {
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        // The view keeps the file open, so both handles can go straight away.
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) return nullptr;
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!data) return nullptr;
+
+        return std::unique_ptr<MappedFile>(new MappedFile(static_cast<std::byte*>(data), static_cast<size_t>(size.QuadPart)));
+    }
+
+    MappedFile::~MappedFile() {
+        UnmapViewOfFile(_data);
+    }
+#else
+    std::unique_ptr<MappedFile> MappedFile::open(const std::filesystem::path& path) {
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) return nullptr;
+
+        struct stat status {};
+        if (fstat(file, &status) != 0 || status.st_size <= 0) {
+            close(file);
+            return nullptr;
+        }
+
+        // The mapping keeps its own reference to the file.
+        auto size = static_cast<size_t>(status.st_size);
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        close(file);
+        if (data == MAP_FAILED) return nullptr;
+
+        return std::unique_ptr<MappedFile>(new MappedFile(static_cast<std::byte*>(data), size));
+    }
+
+    MappedFile::~MappedFile() {
+        munmap(_data, _size);
+    }
+#endif
+
+    std::byte* MappedFile::data() const {
+        return _data;
+    }
+
+    size_t MappedFile::size() const {
+        return _size;
+    }
+}
@@ -0,0 +1,64 @@
+#include "infd/generator/NodeGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace infd::generator {
+    NodeGrid::NodeGrid(float cellSize) :
+        _size(static_cast<unsigned int>(std::ceil(1.f / cellSize))), _cellSize(cellSize), _cells(_size * _size) {}
+
+    int NodeGrid::cellIndex(float value) const {
+        return std::clamp(static_cast<int>(std::floor(value / _cellSize)), 0, static_cast<int>(_size) - 1);
+    }
+
+    std::vector<NodeIndex>& NodeGrid::cell(float x, float y) {
+        return _cells[cellIndex(x) * _size + cellIndex(y)];
+    }
+
+    void NodeGrid::insert(const RoadGraph& graph, NodeIndex node) {
+        cell(graph.x[node], graph.y[node]).push_back(node);
+    }
+
+    void NodeGrid::remove(const RoadGraph& graph, NodeIndex node) {
+        std::vector<NodeIndex>& entries = cell(graph.x[node], graph.y[node]);
+        entries.erase(std::remove(entries.begin(), entries.end(), node), entries.end());
+    }
+
+    void NodeGrid::remap(const std::vector<NodeIndex>& remap) {
+        for (std::vector<NodeIndex>& entries : _cells) {
+            for (NodeIndex& node : entries) {
+                node = remap[node];
+            }
+            entries.erase(std::remove(entries.begin(), entries.end(), NO_NODE), entries.end());
+        }
+    }
+
+    NodeIndex NodeGrid::findNearest(const RoadGraph& graph, float x, float y, NodeIndex initial) const {
+        NodeIndex nearest = initial;
+        float dist = graph.sqDist(nearest, x, y);
+
+        // Only nodes strictly closer than the initial node can win, so the search radius never grows.
+        // Padded slightly so rounding in the square root can't exclude a boundary cell.
+        float radius = std::sqrt(dist) * 1.001f + std::numeric_limits<float>::epsilon();
+
+        int minX = cellIndex(x - radius);
+        int maxX = cellIndex(x + radius);
+        int minY = cellIndex(y - radius);
+        int maxY = cellIndex(y + radius);
+
+        for (int cx = minX; cx <= maxX; cx++) {
+            for (int cy = minY; cy <= maxY; cy++) {
+                for (NodeIndex node : _cells[cx * _size + cy]) {
+                    float newDist = graph.sqDist(node, x, y);
+                    if (newDist < dist || (newDist == dist && nearest != initial && node < nearest)) {
+                        nearest = node;
+                        dist = newDist;
+                    }
+                }
+            }
+        }
+
+        return nearest;
+    }
+}
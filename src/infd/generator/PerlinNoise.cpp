@@ -0,0 +1,336 @@
+#include "infd/generator/PerlinNoise.hpp"
+#include "infd/generator/PerlinNoiseKernels.hpp"
+
+#include <atomic>
+
+#ifdef INFD_PERLIN_X86
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace infd::generator {
+#ifdef INFD_PERLIN_X86
+    namespace kernels {
+        namespace {
+            __m128 fade(__m128 t) {
+                __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+                __m128 inner = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.f)), _mm_set1_ps(15.f));
+                inner = _mm_add_ps(_mm_mul_ps(t, inner), _mm_set1_ps(10.f));
+                return _mm_mul_ps(t3, inner);
+            }
+
+            __m128 lerp(__m128 t, __m128 a, __m128 b) {
+                return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+            }
+
+            // mask ? a : b
+            __m128 select(__m128 mask, __m128 a, __m128 b) {
+                return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+            }
+
+            __m128 grad(__m128i hash, __m128 x, __m128 y, __m128 z) {
+                __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+
+                __m128 hLess8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+                __m128 hLess4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+                __m128 h12or14 = _mm_castsi128_ps(_mm_or_si128(
+                        _mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                        _mm_cmpeq_epi32(h, _mm_set1_epi32(14))
+                ));
+
+                __m128 u = select(hLess8, x, y);
+                __m128 v = select(hLess4, y, select(h12or14, x, z));
+
+                // Bits 0 and 1 of the hash negate u and v, moved into the sign bit.
+                __m128 uSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+                __m128 vSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+
+                return _mm_add_ps(_mm_xor_ps(u, uSign), _mm_xor_ps(v, vSign));
+            }
+
+            __m128 grad(__m128i hash, __m128 x, __m128 y) {
+                return grad(hash, x, y, _mm_setzero_ps());
+            }
+
+            // SSE2 has no gather, so go through memory.
+            __m128i gather(const int* permutation, __m128i index) {
+                alignas(16) int indices[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(indices), index);
+                return _mm_setr_epi32(
+                        permutation[indices[0]],
+                        permutation[indices[1]],
+                        permutation[indices[2]],
+                        permutation[indices[3]]
+                );
+            }
+
+            // SSE2 has no floor either: truncate, then step down where that rounded up.
+            __m128i floor(__m128 value, __m128& floored) {
+                __m128i truncated = _mm_cvttps_epi32(value);
+                __m128 converted = _mm_cvtepi32_ps(truncated);
+                __m128 roundedUp = _mm_cmpgt_ps(converted, value);
+
+                floored = _mm_sub_ps(converted, _mm_and_ps(roundedUp, _mm_set1_ps(1.f)));
+                return _mm_add_epi32(truncated, _mm_castps_si128(roundedUp));
+            }
+        }
+
+        size_t perlinSse2(const int* p, const float* xs, const float* ys, float zValue, size_t n, float* out) {
+            const __m128i mask = _mm_set1_epi32(255);
+            const __m128i one = _mm_set1_epi32(1);
+            const __m128 oneF = _mm_set1_ps(1.f);
+            const __m128 zero = _mm_setzero_ps();
+
+            // z is shared by every lane.
+            __m128 zFloor;
+            __m128i Z = _mm_and_si128(floor(_mm_set1_ps(zValue), zFloor), mask);
+            __m128 z = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(zValue), zFloor), zero);
+            __m128 w = fade(z);
+
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m128 x = _mm_loadu_ps(xs + i);
+                __m128 y = _mm_loadu_ps(ys + i);
+
+                __m128 xFloor;
+                __m128 yFloor;
+                __m128i X = _mm_and_si128(floor(x, xFloor), mask);
+                __m128i Y = _mm_and_si128(floor(y, yFloor), mask);
+
+                // Adding zero turns the -0 of x = -0 into the +0 the scalar subtraction produces.
+                x = _mm_add_ps(_mm_sub_ps(x, xFloor), zero);
+                y = _mm_add_ps(_mm_sub_ps(y, yFloor), zero);
+
+                __m128 u = fade(x);
+                __m128 v = fade(y);
+
+                __m128i A = _mm_add_epi32(gather(p, X), Y);
+                __m128i AA = _mm_add_epi32(gather(p, A), Z);
+                __m128i AB = _mm_add_epi32(gather(p, _mm_add_epi32(A, one)), Z);
+                __m128i B = _mm_add_epi32(gather(p, _mm_add_epi32(X, one)), Y);
+                __m128i BA = _mm_add_epi32(gather(p, B), Z);
+                __m128i BB = _mm_add_epi32(gather(p, _mm_add_epi32(B, one)), Z);
+
+                __m128 x1 = _mm_sub_ps(x, oneF);
+                __m128 y1 = _mm_sub_ps(y, oneF);
+                __m128 z1 = _mm_sub_ps(z, oneF);
+
+                __m128 result = lerp(w,
+                        lerp(v, lerp(u, grad(gather(p, AA), x, y, z),
+                                        grad(gather(p, BA), x1, y, z)),
+                                lerp(u, grad(gather(p, AB), x, y1, z),
+                                        grad(gather(p, BB), x1, y1, z))),
+                        lerp(v, lerp(u, grad(gather(p, _mm_add_epi32(AA, one)), x, y, z1),
+                                        grad(gather(p, _mm_add_epi32(BA, one)), x1, y, z1)),
+                                lerp(u, grad(gather(p, _mm_add_epi32(AB, one)), x, y1, z1),
+                                        grad(gather(p, _mm_add_epi32(BB, one)), x1, y1, z1))));
+
+                _mm_storeu_ps(out + i, result);
+            }
+            return i;
+        }
+
+        size_t perlin2Sse2(const int* p, const float* xs, const float* ys, int layer, size_t n, float* out) {
+            const __m128i mask = _mm_set1_epi32(255);
+            const __m128i one = _mm_set1_epi32(1);
+            const __m128 oneF = _mm_set1_ps(1.f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128i Z = _mm_set1_epi32(layer & 255);
+
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m128 x = _mm_loadu_ps(xs + i);
+                __m128 y = _mm_loadu_ps(ys + i);
+
+                __m128 xFloor;
+                __m128 yFloor;
+                __m128i X = _mm_and_si128(floor(x, xFloor), mask);
+                __m128i Y = _mm_and_si128(floor(y, yFloor), mask);
+
+                x = _mm_add_ps(_mm_sub_ps(x, xFloor), zero);
+                y = _mm_add_ps(_mm_sub_ps(y, yFloor), zero);
+
+                __m128 u = fade(x);
+                __m128 v = fade(y);
+
+                __m128i A = _mm_add_epi32(gather(p, X), Y);
+                __m128i AA = _mm_add_epi32(gather(p, A), Z);
+                __m128i AB = _mm_add_epi32(gather(p, _mm_add_epi32(A, one)), Z);
+                __m128i B = _mm_add_epi32(gather(p, _mm_add_epi32(X, one)), Y);
+                __m128i BA = _mm_add_epi32(gather(p, B), Z);
+                __m128i BB = _mm_add_epi32(gather(p, _mm_add_epi32(B, one)), Z);
+
+                __m128 x1 = _mm_sub_ps(x, oneF);
+                __m128 y1 = _mm_sub_ps(y, oneF);
+
+                __m128 result = lerp(v, lerp(u, grad(gather(p, AA), x, y),
+                                                grad(gather(p, BA), x1, y)),
+                                        lerp(u, grad(gather(p, AB), x, y1),
+                                                grad(gather(p, BB), x1, y1)));
+
+                _mm_storeu_ps(out + i, result);
+            }
+            return i;
+        }
+
+        bool hasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+            __cpuidex(info, 7, 0);
+            return osSavesYmm && (info[1] & (1 << 5));
+#else
+            return false;
+#endif
+        }
+    }
+#endif
+
+    namespace {
+        PerlinNoise::Kernel bestKernel() {
+#ifdef INFD_PERLIN_X86
+            return kernels::hasAvx2() ? PerlinNoise::Kernel::Avx2 : PerlinNoise::Kernel::Sse2;
+#else
+            return PerlinNoise::Kernel::Scalar;
+#endif
+        }
+
+        std::atomic<PerlinNoise::Kernel> currentKernel = bestKernel();
+    }
+
+    bool PerlinNoise::supported(Kernel value) {
+        switch (value) {
+#ifdef INFD_PERLIN_X86
+            case Kernel::Avx2:
+                return kernels::hasAvx2();
+            case Kernel::Sse2:
+                return true;
+#endif
+            case Kernel::Scalar:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    PerlinNoise::Kernel PerlinNoise::kernel() {
+        return currentKernel;
+    }
+
+    void PerlinNoise::kernel(Kernel value) {
+        currentKernel = supported(value) ? value : bestKernel();
+    }
+
+    void PerlinNoise::sampleN(const float* xs, const float* ys, float z, size_t n, float* out) const {
+        size_t i = 0;
+
+#ifdef INFD_PERLIN_X86
+        const int* permutation = _permutationVector.data();
+
+        switch (currentKernel.load(std::memory_order_relaxed)) {
+            case Kernel::Avx2:
+                i += kernels::perlinAvx2(permutation, xs, ys, z, n, out);
+                [[fallthrough]];
+            case Kernel::Sse2:
+                i += kernels::perlinSse2(permutation, xs + i, ys + i, z, n - i, out + i);
+                break;
+            case Kernel::Scalar:
+                break;
+        }
+#endif
+
+        for (; i < n; i++) {
+            out[i] = sample<float>(xs[i], ys[i], z);
+        }
+    }
+
+    void PerlinNoise::sampleLayer(const float* xs, const float* ys, int layer, size_t n, float* out) const {
+        size_t i = 0;
+
+#ifdef INFD_PERLIN_X86
+        const int* permutation = _permutationVector.data();
+
+        switch (currentKernel.load(std::memory_order_relaxed)) {
+            case Kernel::Avx2:
+                i += kernels::perlin2Avx2(permutation, xs, ys, layer, n, out);
+                [[fallthrough]];
+            case Kernel::Sse2:
+                i += kernels::perlin2Sse2(permutation, xs + i, ys + i, layer, n - i, out + i);
+                break;
+            case Kernel::Scalar:
+                break;
+        }
+#endif
+
+        for (; i < n; i++) {
+            out[i] = sample<float>(xs[i], ys[i], layer);
+        }
+    }
+
+    void PerlinNoise::sampleN(const float* xs, const float* ys, size_t n, const Fractal& fractal, float* out) const {
+        if (fractal.octaves == 0) {
+            std::fill(out, out + n, 0.f);
+            return;
+        }
+
+        // Only allocated for what the octaves need, so a single octave at frequency 1 costs no more than the kernel.
+        std::vector<float> scaledXs;
+        std::vector<float> scaledYs;
+        std::vector<float> octave;
+
+        float frequency = fractal.frequency;
+        float amplitude = 1;
+
+        for (unsigned int o = 0; o < fractal.octaves; o++) {
+            const float* octaveXs = xs;
+            const float* octaveYs = ys;
+            if (frequency != 1) {
+                scaledXs.resize(n);
+                scaledYs.resize(n);
+                for (size_t i = 0; i < n; i++) {
+                    scaledXs[i] = xs[i] * frequency;
+                    scaledYs[i] = ys[i] * frequency;
+                }
+                octaveXs = scaledXs.data();
+                octaveYs = scaledYs.data();
+            }
+
+            int layer = fractal.layer + static_cast<int>(o);
+            if (o == 0) {
+                // As the scalar sum starting from 0, which turns -0 into +0.
+                sampleLayer(octaveXs, octaveYs, layer, n, out);
+                for (size_t i = 0; i < n; i++) {
+                    out[i] = 0.f + out[i];
+                }
+            } else {
+                octave.resize(n);
+                sampleLayer(octaveXs, octaveYs, layer, n, octave.data());
+                for (size_t i = 0; i < n; i++) {
+                    out[i] += amplitude * octave[i];
+                }
+            }
+
+            frequency *= fractal.lacunarity;
+            amplitude *= fractal.gain;
+        }
+    }
+
+    void PerlinNoise::sampleGrid(float x0, float y0, float dx, float dy, size_t w, size_t h, float z, float* out) const {
+        std::vector<float> xs(w);
+        std::vector<float> ys(w);
+
+        for (size_t i = 0; i < w; i++) {
+            xs[i] = static_cast<float>(i) * dx + x0;
+        }
+
+        for (size_t j = 0; j < h; j++) {
+            std::fill(ys.begin(), ys.end(), static_cast<float>(j) * dy + y0);
+            sampleN(xs.data(), ys.data(), z, w, out + j * w);
+        }
+    }
+}
@@ -0,0 +1,151 @@
+// Built with AVX2 enabled. Keep this file free of inline functions shared with other translation units (including
+// most of the standard library), otherwise the linker may pick an AVX2 copy for code that runs on older CPUs.
+
+#include "infd/generator/PerlinNoiseKernels.hpp"
+
+#ifdef INFD_PERLIN_X86
+
+#include <immintrin.h>
+
+namespace infd::generator::kernels {
+    namespace {
+        __m256 fade(__m256 t) {
+            __m256 t3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+            __m256 inner = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.f)), _mm256_set1_ps(15.f));
+            inner = _mm256_add_ps(_mm256_mul_ps(t, inner), _mm256_set1_ps(10.f));
+            return _mm256_mul_ps(t3, inner);
+        }
+
+        __m256 lerp(__m256 t, __m256 a, __m256 b) {
+            return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+        }
+
+        __m256 grad(__m256i hash, __m256 x, __m256 y, __m256 z) {
+            __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+
+            __m256 hLess8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+            __m256 hLess4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+            __m256 h12or14 = _mm256_castsi256_ps(_mm256_or_si256(
+                    _mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+                    _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))
+            ));
+
+            __m256 u = _mm256_blendv_ps(y, x, hLess8);
+            __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, h12or14), y, hLess4);
+
+            // Bits 0 and 1 of the hash negate u and v, moved into the sign bit.
+            __m256 uSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+            __m256 vSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+
+            return _mm256_add_ps(_mm256_xor_ps(u, uSign), _mm256_xor_ps(v, vSign));
+        }
+
+        __m256 grad(__m256i hash, __m256 x, __m256 y) {
+            return grad(hash, x, y, _mm256_setzero_ps());
+        }
+
+        __m256i gather(const int* permutation, __m256i index) {
+            return _mm256_i32gather_epi32(permutation, index, 4);
+        }
+    }
+
+    size_t perlinAvx2(const int* p, const float* xs, const float* ys, float zValue, size_t n, float* out) {
+        const __m256i mask = _mm256_set1_epi32(255);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256 oneF = _mm256_set1_ps(1.f);
+        const __m256 zero = _mm256_setzero_ps();
+
+        // z is shared by every lane.
+        __m256 zFloor = _mm256_floor_ps(_mm256_set1_ps(zValue));
+        __m256i Z = _mm256_and_si256(_mm256_cvttps_epi32(zFloor), mask);
+        __m256 z = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(zValue), zFloor), zero);
+        __m256 w = fade(z);
+
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 x = _mm256_loadu_ps(xs + i);
+            __m256 y = _mm256_loadu_ps(ys + i);
+
+            __m256 xFloor = _mm256_floor_ps(x);
+            __m256 yFloor = _mm256_floor_ps(y);
+            __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(xFloor), mask);
+            __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(yFloor), mask);
+
+            // Adding zero turns the -0 of x = -0 into the +0 the scalar subtraction produces.
+            x = _mm256_add_ps(_mm256_sub_ps(x, xFloor), zero);
+            y = _mm256_add_ps(_mm256_sub_ps(y, yFloor), zero);
+
+            __m256 u = fade(x);
+            __m256 v = fade(y);
+
+            __m256i A = _mm256_add_epi32(gather(p, X), Y);
+            __m256i AA = _mm256_add_epi32(gather(p, A), Z);
+            __m256i AB = _mm256_add_epi32(gather(p, _mm256_add_epi32(A, one)), Z);
+            __m256i B = _mm256_add_epi32(gather(p, _mm256_add_epi32(X, one)), Y);
+            __m256i BA = _mm256_add_epi32(gather(p, B), Z);
+            __m256i BB = _mm256_add_epi32(gather(p, _mm256_add_epi32(B, one)), Z);
+
+            __m256 x1 = _mm256_sub_ps(x, oneF);
+            __m256 y1 = _mm256_sub_ps(y, oneF);
+            __m256 z1 = _mm256_sub_ps(z, oneF);
+
+            __m256 result = lerp(w,
+                    lerp(v, lerp(u, grad(gather(p, AA), x, y, z),
+                                    grad(gather(p, BA), x1, y, z)),
+                            lerp(u, grad(gather(p, AB), x, y1, z),
+                                    grad(gather(p, BB), x1, y1, z))),
+                    lerp(v, lerp(u, grad(gather(p, _mm256_add_epi32(AA, one)), x, y, z1),
+                                    grad(gather(p, _mm256_add_epi32(BA, one)), x1, y, z1)),
+                            lerp(u, grad(gather(p, _mm256_add_epi32(AB, one)), x, y1, z1),
+                                    grad(gather(p, _mm256_add_epi32(BB, one)), x1, y1, z1))));
+
+            _mm256_storeu_ps(out + i, result);
+        }
+        return i;
+    }
+
+    size_t perlin2Avx2(const int* p, const float* xs, const float* ys, int layer, size_t n, float* out) {
+        const __m256i mask = _mm256_set1_epi32(255);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256 oneF = _mm256_set1_ps(1.f);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256i Z = _mm256_set1_epi32(layer & 255);
+
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 x = _mm256_loadu_ps(xs + i);
+            __m256 y = _mm256_loadu_ps(ys + i);
+
+            __m256 xFloor = _mm256_floor_ps(x);
+            __m256 yFloor = _mm256_floor_ps(y);
+            __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(xFloor), mask);
+            __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(yFloor), mask);
+
+            x = _mm256_add_ps(_mm256_sub_ps(x, xFloor), zero);
+            y = _mm256_add_ps(_mm256_sub_ps(y, yFloor), zero);
+
+            __m256 u = fade(x);
+            __m256 v = fade(y);
+
+            __m256i A = _mm256_add_epi32(gather(p, X), Y);
+            __m256i AA = _mm256_add_epi32(gather(p, A), Z);
+            __m256i AB = _mm256_add_epi32(gather(p, _mm256_add_epi32(A, one)), Z);
+            __m256i B = _mm256_add_epi32(gather(p, _mm256_add_epi32(X, one)), Y);
+            __m256i BA = _mm256_add_epi32(gather(p, B), Z);
+            __m256i BB = _mm256_add_epi32(gather(p, _mm256_add_epi32(B, one)), Z);
+
+            __m256 x1 = _mm256_sub_ps(x, oneF);
+            __m256 y1 = _mm256_sub_ps(y, oneF);
+
+            __m256 result = lerp(v, lerp(u, grad(gather(p, AA), x, y),
+                                            grad(gather(p, BA), x1, y)),
+                                    lerp(u, grad(gather(p, AB), x, y1),
+                                            grad(gather(p, BB), x1, y1)));
+
+            _mm256_storeu_ps(out + i, result);
+        }
+        return i;
+    }
+}
+
+#endif
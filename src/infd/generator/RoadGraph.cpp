@@ -0,0 +1,164 @@
+#include "infd/generator/RoadGraph.hpp"
+#include "infd/generator/ChunkGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+
+namespace infd::generator {
+    float RoadGraph::sqDist(NodeIndex node, float x_, float y_) const {
+        return (x_ - x[node]) * (x_ - x[node]) + (y_ - y[node]) * (y_ - y[node]);
+    }
+
+    NodeIndex RoadGraph::addNode(float x_, float y_, float angle_, bool isRoot_, unsigned int depth_, unsigned int category_) {
+        auto index = static_cast<NodeIndex>(x.size());
+
+        x.push_back(x_);
+        y.push_back(y_);
+        angle.push_back(angle_);
+        depth.push_back(depth_);
+        category.push_back(std::min(category_, MAX_DEPTH));
+        isRoot.push_back(isRoot_);
+        degree.push_back(0);
+
+        _firstEdge.push_back(NO_EDGE);
+        _removed.push_back(false);
+
+        return index;
+    }
+
+    void RoadGraph::addEdge(NodeIndex a, NodeIndex b) {
+        auto ab = static_cast<EdgeIndex>(edgeTo.size());
+        EdgeIndex ba = ab + 1;
+
+        for (auto [from, to, e, twin] : {std::tuple{a, b, ab, ba}, std::tuple{b, a, ba, ab}}) {
+            edgeFrom.push_back(from);
+            edgeTo.push_back(to);
+            edgeAngle.push_back(std::atan2(x[to] - x[from], y[to] - y[from]));
+            edgeTwin.push_back(twin);
+            edgeVisited.push_back(false);
+
+            _nextEdge.push_back(_firstEdge[from]);
+            _firstEdge[from] = e;
+            degree[from]++;
+        }
+    }
+
+    bool RoadGraph::connected(NodeIndex a, NodeIndex b) const {
+        for (EdgeIndex e = _firstEdge[a]; e != NO_EDGE; e = _nextEdge[e]) {
+            if (edgeTo[e] == b) return true;
+        }
+        return false;
+    }
+
+    std::vector<NodeIndex> RoadGraph::compact() {
+        std::vector<NodeIndex> remap(size(), NO_NODE);
+
+        NodeIndex count = 0;
+        for (NodeIndex node = 0; node < size(); node++) {
+            if (_removed[node]) continue;
+
+            remap[node] = count;
+            x[count] = x[node];
+            y[count] = y[node];
+            angle[count] = angle[node];
+            depth[count] = depth[node];
+            category[count] = category[node];
+            isRoot[count] = isRoot[node];
+            degree[count] = degree[node];
+            count++;
+        }
+
+        for (std::vector<float>* values : {&x, &y, &angle}) values->resize(count);
+        for (std::vector<unsigned int>* values : {&depth, &category, &degree}) values->resize(count);
+        isRoot.resize(count);
+
+        // Lay out surviving half-edges contiguously per node.
+        edgeOffset.assign(count + 1, 0);
+        for (NodeIndex node = 0; node < count; node++) {
+            edgeOffset[node + 1] = edgeOffset[node] + degree[node];
+        }
+
+        EdgeIndex edges = edgeOffset[count];
+        std::vector<EdgeIndex> position(edgeTo.size(), NO_EDGE);
+        std::vector<NodeIndex> from(edges);
+        std::vector<NodeIndex> to(edges);
+        std::vector<float> angles(edges);
+        std::vector<EdgeIndex> twins(edges);
+
+        EdgeIndex next = 0;
+        for (NodeIndex node = 0; node < remap.size(); node++) {
+            if (remap[node] == NO_NODE) continue;
+
+            for (EdgeIndex e = _firstEdge[node]; e != NO_EDGE; e = _nextEdge[e]) {
+                if (edgeTo[e] == NO_NODE) continue;
+
+                position[e] = next;
+                from[next] = remap[node];
+                to[next] = remap[edgeTo[e]];
+                angles[next] = edgeAngle[e];
+                twins[next] = edgeTwin[e];
+                next++;
+            }
+        }
+
+        for (EdgeIndex& twin : twins) {
+            twin = position[twin];
+        }
+
+        edgeFrom = std::move(from);
+        edgeTo = std::move(to);
+        edgeAngle = std::move(angles);
+        edgeTwin = std::move(twins);
+        edgeVisited.assign(edges, false);
+
+        _firstEdge = {};
+        _nextEdge = {};
+        _removed = {};
+
+        return remap;
+    }
+
+    void RoadGraph::sortEdges() {
+        std::vector<EdgeIndex> order(edgeCount());
+        std::iota(order.begin(), order.end(), 0);
+
+        for (NodeIndex node = 0; node < size(); node++) {
+            std::sort(
+                    order.begin() + edgesBegin(node),
+                    order.begin() + edgesEnd(node),
+                    [this](EdgeIndex a, EdgeIndex b) { return edgeAngle[a] < edgeAngle[b]; }
+            );
+        }
+
+        std::vector<EdgeIndex> position(edgeCount());
+        for (EdgeIndex e = 0; e < edgeCount(); e++) {
+            position[order[e]] = e;
+        }
+
+        std::vector<NodeIndex> to(edgeCount());
+        std::vector<float> angles(edgeCount());
+        std::vector<EdgeIndex> twins(edgeCount());
+        for (EdgeIndex e = 0; e < edgeCount(); e++) {
+            to[e] = edgeTo[order[e]];
+            angles[e] = edgeAngle[order[e]];
+            twins[e] = position[edgeTwin[order[e]]];
+        }
+
+        edgeTo = std::move(to);
+        edgeAngle = std::move(angles);
+        edgeTwin = std::move(twins);
+
+        // The successor of the twin at the far node, i.e. the first edge there turning past the way we came in.
+        edgeNext.resize(edgeCount());
+        for (EdgeIndex e = 0; e < edgeCount(); e++) {
+            EdgeIndex twin = edgeTwin[e];
+            EdgeIndex next = twin + 1;
+            EdgeIndex end = edgesEnd(edgeTo[e]);
+
+            while (next < end && edgeAngle[next] <= edgeAngle[twin]) next++;
+            edgeNext[e] = next < end ? next : edgesBegin(edgeTo[e]);
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#include "infd/generator/TerrainGrids.hpp"
+#include "infd/generator/meshbuilding/PerlinMesh.hpp"
+#include "infd/ScopeGuard.hpp"
+
+namespace infd::generator {
+    TerrainGrids::TerrainGrids(unsigned int resolution) : _resolution(resolution) {}
+
+    unsigned int TerrainGrids::resolution() const {
+        return _resolution;
+    }
+
+    const GLMesh& TerrainGrids::get(unsigned int stride) {
+        auto it = _grids.find(stride);
+        if (it == _grids.end()) {
+            it = _grids.emplace(stride, meshbuilding::generateTerrainGrid(_resolution, stride).build()).first;
+        }
+        return it->second;
+    }
+
+    GLTexture TerrainGrids::heights(const Heightfield& heightfield) {
+        GLTexture heights;
+        auto size = static_cast<GLsizei>(heightfield.resolution() + 3);
+
+        auto guard = scopedBind(heights, GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, size, size, 0, GL_RED, GL_FLOAT, heightfield.samples().data());
+
+        return heights;
+    }
+}
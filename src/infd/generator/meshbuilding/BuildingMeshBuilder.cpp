@@ -6,23 +6,31 @@ namespace infd::generator::meshbuilding {
 
     using namespace Clipper2Lib;
 
-    BuildingMeshBuilder::BuildingMeshBuilder(ChunkGenerator &generator, PathD& path, helpers::RandomType& random) :
-        x(generator.x), y(generator.y), noise(generator.perlinNoise), originPath(path), random(random) {}
+    BuildingMeshBuilder::BuildingMeshBuilder(ChunkGenerator &generator, PathD& path, helpers::RandomType& random,
+                                             std::pmr::memory_resource* resource) :
+        random(random), resource(resource), mesh(resource), heightfield(generator.heightfield), originPath(path),
+        workspace(threadWorkspace()) {}
+
+    BuildingMeshBuilder::Workspace& BuildingMeshBuilder::threadWorkspace() {
+        thread_local Workspace workspace;
+        return workspace;
+    }
 
-    auto BuildingMeshBuilder::findRadiusBounds(PathD &path) {
+    auto BuildingMeshBuilder::findRadiusBounds(const Path64 &path) {
         struct Result {
             glm::vec2 radius = glm::vec2(0, std::numeric_limits<float>::max());
             PointD point;
         } result;
 
-        for (PointD& p : path) {
-            result.point = result.point + p;
+        for (const Point64& p : path) {
+            result.point.x += static_cast<double>(p.x);
+            result.point.y += static_cast<double>(p.y);
         }
         result.point = PointD(result.point.x / path.size(), result.point.y / path.size());
 
         for (unsigned int i = 1; i < path.size(); i++) {
-            float x = path[i].x-result.point.x;
-            float y = path[i].y-result.point.y;
+            float x = static_cast<double>(path[i].x)-result.point.x;
+            float y = static_cast<double>(path[i].y)-result.point.y;
 
             float r = std::sqrt(x*x + y*y);
 
@@ -32,24 +40,42 @@ namespace infd::generator::meshbuilding {
         return result;
     }
 
-    BuildingMeshBuilder::Result BuildingMeshBuilder::build() {
-        PathD basePath = scalePath(originPath, scaleFactor);
-        PathD path = shrinkPath(basePath, -ROAD_PADDING_WIDTH);
+    MeshData BuildingMeshBuilder::build() {
+        // Enough for the pad and the two hulls of a khrushchevka. Skyscrapers grow it.
+        mesh.reserve(9 * originPath.size(), 9 * originPath.size());
 
-        if (path.empty()) {
-            return {
-                    mb.build(),
-                    std::move(tri_mesh)
-            };
-        }
+        glm::vec2 heights;
+        generate(heights);
+
+        return mesh.data();
+    }
+
+    std::optional<Block> BuildingMeshBuilder::block(double tolerance) {
+        meshing = false;
+
+        glm::vec2 heights;
+        Path64 footprint = generate(heights);
+        if (footprint.empty()) return std::nullopt;
 
-        scalePath(path, 1/scaleFactor);
+        footprint = SimplifyPath(footprint, tolerance * fixedScale);
+        if (footprint.size() < 3) return std::nullopt;
 
-        glm::vec2 heights = findHeightBounds(path);
+        return Block{toChunk(footprint), heights[1], top};
+    }
+
+    Path64 BuildingMeshBuilder::generate(glm::vec2& heights) {
+        Path64 basePath = toFixed(originPath);
+        Path64 path = shrinkPath(basePath, -ROAD_PADDING_WIDTH);
+
+        if (path.empty()) return {};
 
-        processHull(path, ROAD_HEIGHT+heights[0], (heights[1]-heights[0])-ROAD_HEIGHT);
+        PathD& hull = toChunk(path);
 
-        PathD buildingPath = shrinkPath(basePath, -ROAD_PADDING_WIDTH-BUILDING_PADDING_WIDTH);
+        heights = findHeightBounds(hull);
+
+        processHull(hull, ROAD_HEIGHT+heights[0], (heights[1]-heights[0])-ROAD_HEIGHT);
+
+        Path64 buildingPath = shrinkPath(basePath, -ROAD_PADDING_WIDTH-BUILDING_PADDING_WIDTH);
 
         if (originPath.size() < MAX_KHRUSHCHEVKA) {
             generateKhrushchevka(buildingPath, heights[0]);
@@ -63,43 +89,48 @@ namespace infd::generator::meshbuilding {
             }
         }
 
-        return {
-            mb.build(),
-            std::move(tri_mesh)
-        };
+        return buildingPath;
     }
 
-    PathD& BuildingMeshBuilder::scalePath(PathD& path, float factor) {
-        for (unsigned int i = 0; i < path.size(); i++) {
-            path[i] = path[i]*factor;
+    Path64 BuildingMeshBuilder::toFixed(const PathD& path) {
+        Path64 result;
+        result.reserve(path.size());
+        for (const PointD& point : path) {
+            result.emplace_back(point.x * fixedScale, point.y * fixedScale);
         }
+        return result;
+    }
 
-        return path;
+    PathD& BuildingMeshBuilder::toChunk(const Path64& path) {
+        PathD& result = workspace.chunkPath;
+        result.clear();
+        for (const Point64& point : path) {
+            result.emplace_back(static_cast<double>(point.x) / fixedScale, static_cast<double>(point.y) / fixedScale);
+        }
+        return result;
     }
 
-    PathD BuildingMeshBuilder::shrinkPath(PathD &path, float factor) {
-        PathsD paths = InflatePaths(
-                {path}, factor * scaleFactor, JoinType::Miter, EndType::Polygon
-        );
+    Path64 BuildingMeshBuilder::shrinkPath(const Path64& path, double offset) {
+        workspace.offset.Clear();
+        workspace.offset.AddPath(path, JoinType::Miter, EndType::Polygon);
+        workspace.offset.Execute(offset * fixedScale, workspace.solution);
 
-        return paths.empty() ? PathD() : SimplifyPath(
-                paths[0],
-                0.1f
+        return workspace.solution.empty() ? Path64() : SimplifyPath(
+                workspace.solution[0],
+                simplifyTolerance * fixedScale
         );
     }
 
     void BuildingMeshBuilder::processRoof(PathD &path, float height) {
-        Polygon polygon;
+        Polygon polygon(resource);
+        polygon.reserve(path.size());
         for (PointD& point : path) {
             glm::vec2 p(point.x, point.y);
             polygon.addPoint(p);
         }
 
-        std::vector<p2t::Triangle*> triangles = polygon.triangulate();
-        for (p2t::Triangle* tri : triangles) {
-            Triangle t = Triangle::convertTo(*tri, glm::vec3(height));
-            t.addToMesh(mb, index);
-            t.addToCollision(*tri_mesh);
+        for (const Polygon::Face& face : polygon.triangulate()) {
+            mesh.drawColliding(polygon.convert(face, glm::vec3(height)));
         }
     }
 
@@ -123,18 +154,17 @@ namespace infd::generator::meshbuilding {
     }
 
     void BuildingMeshBuilder::drawTriangle(Triangle &tri) {
-        tri.addToMesh(mb, index);
+        mesh.draw(tri);
     }
 
     void BuildingMeshBuilder::drawCollidingTriangle(Triangle &tri) {
-        tri.addToMesh(mb, index);
-        tri.addToCollision(*tri_mesh);
+        mesh.drawColliding(tri);
     }
 
     glm::vec2 BuildingMeshBuilder::findHeightBounds(PathD &path) {
-        glm::vec2 heights(ChunkGenerator::scaledPerlin(path.front().x + x, path.front().y + y, noise)*PERLIN_TERRAIN_FACTOR);
+        glm::vec2 heights(heightfield.sample(path.front().x, path.front().y));
         for (unsigned int i = 1; i < path.size(); i++) {
-            float height = ChunkGenerator::scaledPerlin(path[i].x + x, path[i].y + y, noise)*PERLIN_TERRAIN_FACTOR;
+            float height = heightfield.sample(path[i].x, path[i].y);
             if (height > heights[0]) heights[0] = height;
             if (height < heights[1]) heights[1] = height;
         }
@@ -142,74 +172,73 @@ namespace infd::generator::meshbuilding {
     }
 
     void BuildingMeshBuilder::processHull(PathD &path, float height, float depth) {
+        if (!meshing) {
+            top = std::max(top, height);
+            return;
+        }
+
+        // A wall of two triangles per point, and fewer roof triangles than points.
+        mesh.reserve(3 * path.size(), 3 * path.size());
         processWalls(path, height, depth);
         processRoof(path, height);
     }
 
-    void BuildingMeshBuilder::generateKhrushchevka(PathD basis, float floorHeight) {
-        PathD roof = BuildingMeshBuilder::shrinkPath(basis, -BUILDING_ROOF_INDENT);
+    void BuildingMeshBuilder::generateKhrushchevka(const Path64& basis, float floorHeight) {
+        // A block only needs the height of the roof, not its outline.
+        Path64 roof = meshing ? shrinkPath(basis, -BUILDING_ROOF_INDENT) : basis;
 
-        scalePath(basis, 1/scaleFactor);
-        scalePath(roof, 1/scaleFactor);
-
-        int floors = khrushchevkaDist(random);
+        int floors = random.uniformInt(MIN_KHRUSHCHEVKA_STOREYS, MAX_KHRUSHCHEVKA_STOREYS);
         float buildingHeight = floors*BUILDING_STOREY_HEIGHT;
 
-        processHull(basis, floorHeight+buildingHeight, -buildingHeight);
-        processHull(roof, floorHeight+buildingHeight+BUILDING_ROOFCAP_HEIGHT, -BUILDING_ROOFCAP_HEIGHT);
+        processHull(toChunk(basis), floorHeight+buildingHeight, -buildingHeight);
+        processHull(toChunk(roof), floorHeight+buildingHeight+BUILDING_ROOFCAP_HEIGHT, -BUILDING_ROOFCAP_HEIGHT);
     }
 
-    PathD BuildingMeshBuilder::removeVertices(PathD &source, unsigned int count, unsigned int index) {
-        PathD output;
-        for (unsigned int i = 0; i < count; i++) {
-            output.push_back(source[(i+index) % (source.size()-1)]);
-        }
-        return output;
-    }
+    void BuildingMeshBuilder::generateSkyscraper(const Path64& basis, float floorHeight, float min_radius, const PointD& center) {
+        Path64 hull = generatePolygon(min_radius/4, 8, center);
 
-    void BuildingMeshBuilder::generateSkyscraper(PathD& basis, float floorHeight, float min_radius, PointD& center) {
-        PathD hull = generatePolygon(min_radius/4, 8, center);
-
-        PathsD children;
-        for (PointD& origin : hull) {
-            children.push_back(generatePolygon(min_radius/2 * skyscraperChildrenDist(random), 8, origin));
+        Paths64 children;
+        children.reserve(hull.size());
+        for (Point64& origin : hull) {
+            PointD point(static_cast<double>(origin.x), static_cast<double>(origin.y));
+            children.push_back(generatePolygon(min_radius/2 * random.uniform(MIN_SKYSCRAPER_CHILD_SCALE, MAX_SKYSCRAPER_CHILD_SCALE), 8, point));
         }
 
-        std::shuffle(children.begin(), children.end(), random);
+        helpers::shuffle(children.begin(), children.end(), random);
 
-        PathsD output = {hull};
+        Paths64 output = {hull};
+        output.reserve(1 + children.size());
         for (unsigned int i = 0; i < children.size(); i++) {
-            if (probabilityDist(random) < SKYSCRAPER_LAYER_CHANCE) {
-                output.push_back(unionPath(output.back(), children[i]));
+            if (random.uniform() < SKYSCRAPER_LAYER_CHANCE) {
+                // Likewise, only the number of layers matters to a block.
+                output.push_back(meshing ? unionPath(output.back(), children[i]) : output.back());
             }
         }
 
         float height = 0.f;
 
         for (int i = output.size()-1; i >= 0; i--) {
-            float layerHeight = BUILDING_STOREY_HEIGHT*skyscraperLayerDist(random);
+            float layerHeight = BUILDING_STOREY_HEIGHT*random.uniformInt(MIN_SKYSCRAPER_LAYER_STOREYS, MAX_SKYSCRAPER_LAYER_STOREYS);
             height += layerHeight;
-            PathD layer = output[i];
-            BuildingMeshBuilder::scalePath(layer, 1/scaleFactor);
-            processHull(layer, floorHeight+height, -layerHeight);
+            processHull(toChunk(output[i]), floorHeight+height, -layerHeight);
         }
         {
-            float layerHeight = BUILDING_STOREY_HEIGHT*skyscraperLayerDist(random)*2.f;
+            float layerHeight = BUILDING_STOREY_HEIGHT*random.uniformInt(MIN_SKYSCRAPER_LAYER_STOREYS, MAX_SKYSCRAPER_LAYER_STOREYS)*2.f;
             height += layerHeight;
 
-            PathD layer = BuildingMeshBuilder::shrinkPath(output.front(), -BUILDING_ROOF_INDENT);
+            Path64 layer = shrinkPath(output.front(), -BUILDING_ROOF_INDENT);
 
             if (layer.empty()) {
                 return;
             }
 
-            BuildingMeshBuilder::scalePath(layer, 1/scaleFactor);
-            processHull(layer, floorHeight+height, -layerHeight);
+            processHull(toChunk(layer), floorHeight+height, -layerHeight);
         }
     }
 
-    PathD BuildingMeshBuilder::generatePolygon(float radius, unsigned int sides, const PointD& origin) {
-        PathD outline;
+    Path64 BuildingMeshBuilder::generatePolygon(float radius, unsigned int sides, const PointD& origin) {
+        Path64 outline;
+        outline.reserve(sides);
 
         float theta = glm::two_pi<float>() / sides;
 
@@ -223,10 +252,17 @@ namespace infd::generator::meshbuilding {
         return outline;
     }
 
-    PathD BuildingMeshBuilder::unionPath(PathD &a, PathD &b) {
-        PathsD a_ = {a};
-        PathsD b_ = {b};
+    Path64 BuildingMeshBuilder::unionPath(const Path64 &a, const Path64 &b) {
+        workspace.subject.resize(1);
+        workspace.subject[0].assign(a.begin(), a.end());
+        workspace.clip.resize(1);
+        workspace.clip[0].assign(b.begin(), b.end());
+
+        workspace.clipper.Clear();
+        workspace.clipper.AddSubject(workspace.subject);
+        workspace.clipper.AddClip(workspace.clip);
+        workspace.clipper.Execute(ClipType::Union, FillRule::NonZero, workspace.solution);
 
-        return Union(a_, b_, FillRule::NonZero)[0];
+        return workspace.solution[0];
     }
-}
\ No newline at end of file
+}
@@ -1,10 +1,77 @@
 #include <infd/generator/meshbuilding/Polygon.hpp>
 #include "poly2tri/poly2tri.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace infd::generator::meshbuilding {
 
     const double EPSILON = 1e-12;
 
+    namespace {
+        // Twice the signed area of abc, positive if it turns ccw.
+        double cross(const p2t::Point& a, const p2t::Point& b, const p2t::Point& c) {
+            return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        }
+
+        // For p known to be collinear with ab.
+        bool onSegment(const p2t::Point& a, const p2t::Point& b, const p2t::Point& p) {
+            return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) &&
+                   std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+        }
+
+        // Whether ab and cd share any point, touching included.
+        bool intersects(const p2t::Point& a, const p2t::Point& b, const p2t::Point& c, const p2t::Point& d) {
+            double abc = cross(a, b, c);
+            double abd = cross(a, b, d);
+            double cda = cross(c, d, a);
+            double cdb = cross(c, d, b);
+
+            if (((abc > 0 && abd < 0) || (abc < 0 && abd > 0)) && ((cda > 0 && cdb < 0) || (cda < 0 && cdb > 0))) {
+                return true;
+            }
+
+            return (abc == 0 && onSegment(a, b, c)) || (abd == 0 && onSegment(a, b, d)) ||
+                   (cda == 0 && onSegment(c, d, a)) || (cdb == 0 && onSegment(c, d, b));
+        }
+
+        // Whether no two edges that aren't neighbours touch. Quadratic, so only for small polygons.
+        bool isSimple(const std::pmr::vector<p2t::Point>& points) {
+            size_t n = points.size();
+            for (size_t i = 0; i < n; i++) {
+                for (size_t j = i + 2; j < n; j++) {
+                    if (i == 0 && j == n - 1) continue;
+                    if (intersects(points[i], points[i + 1], points[j], points[(j + 1) % n])) return false;
+                }
+            }
+            return true;
+        }
+
+        double signedArea(const std::pmr::vector<p2t::Point>& points) {
+            double area = 0;
+            for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+                area += points[j].x * points[i].y - points[i].x * points[j].y;
+            }
+            return area / 2;
+        }
+
+        // Adds the triangle abc of a polygon wound ccw or cw, in poly2tri's winding.
+        void addFace(std::pmr::vector<Polygon::Face>& faces, unsigned int a, unsigned int b, unsigned int c, bool ccw) {
+            if (ccw) {
+                faces.push_back({a, b, c});
+            } else {
+                faces.push_back({a, c, b});
+            }
+        }
+    }
+
+    Polygon::Polygon(std::pmr::memory_resource* resource) : _faces(resource), points(resource) {}
+
+    void Polygon::reserve(size_t count) {
+        points.reserve(count);
+        _faces.reserve(count < 3 ? 0 : count - 2);
+    }
+
     void Polygon::addPoint(glm::vec2& point) {
         double x = point.x;
         double y = point.y;
@@ -21,7 +88,102 @@ namespace infd::generator::meshbuilding {
         points.emplace_back(x, y);
     }
 
-    std::vector<p2t::Triangle*> Polygon::triangulate() {
+    const std::pmr::vector<Polygon::Face>& Polygon::triangulate() {
+        _faces.clear();
+
+        if (points.size() < 3 || points.size() > MAX_EAR_CLIPPING_POINTS) return triangulateCdt();
+
+        double area = signedArea(points);
+        if (area == 0 || !isSimple(points)) return triangulateCdt();
+
+        bool ccw = area > 0;
+        if (triangulateFan(ccw) || triangulateEars(ccw)) return _faces;
+
+        return triangulateCdt();
+    }
+
+    bool Polygon::triangulateFan(bool ccw) {
+        auto n = static_cast<unsigned int>(points.size());
+        double sign = ccw ? 1 : -1;
+
+        // Collinear points would leave slivers, so they count as not convex.
+        for (unsigned int i = 0; i < n; i++) {
+            if (sign * cross(points[(i + n - 1) % n], points[i], points[(i + 1) % n]) <= 0) return false;
+        }
+
+        _faces.reserve(n - 2);
+        for (unsigned int i = 1; i + 1 < n; i++) {
+            addFace(_faces, 0, i, i + 1, ccw);
+        }
+
+        _method = Method::Fan;
+        return true;
+    }
+
+    bool Polygon::triangulateEars(bool ccw) {
+        std::array<unsigned int, MAX_EAR_CLIPPING_POINTS> remaining;
+        auto n = static_cast<unsigned int>(points.size());
+        double sign = ccw ? 1 : -1;
+
+        for (unsigned int i = 0; i < n; i++) {
+            remaining[i] = i;
+        }
+
+        _faces.reserve(n - 2);
+
+        // Carries on from the last ear, so a convex run is clipped in one pass.
+        unsigned int k = 0;
+        while (n > 3) {
+            bool clipped = false;
+
+            for (unsigned int attempt = 0; attempt < n; attempt++, k = (k + 1) % n) {
+                unsigned int prev = remaining[(k + n - 1) % n];
+                unsigned int current = remaining[k];
+                unsigned int next = remaining[(k + 1) % n];
+
+                const p2t::Point& a = points[prev];
+                const p2t::Point& b = points[current];
+                const p2t::Point& c = points[next];
+                if (sign * cross(a, b, c) <= 0) continue;
+
+                bool empty = true;
+                for (unsigned int j = 0; j < n && empty; j++) {
+                    unsigned int other = remaining[j];
+                    if (other == prev || other == current || other == next) continue;
+
+                    const p2t::Point& p = points[other];
+                    empty = !(sign * cross(a, b, p) >= 0 && sign * cross(b, c, p) >= 0 && sign * cross(c, a, p) >= 0);
+                }
+                if (!empty) continue;
+
+                addFace(_faces, prev, current, next, ccw);
+                std::copy(remaining.begin() + k + 1, remaining.begin() + n, remaining.begin() + k);
+                n--;
+                k %= n;
+                clipped = true;
+                break;
+            }
+
+            // Only happens with degenerate input, which the CDT handles better.
+            if (!clipped) {
+                _faces.clear();
+                return false;
+            }
+        }
+
+        if (sign * cross(points[remaining[0]], points[remaining[1]], points[remaining[2]]) <= 0) {
+            _faces.clear();
+            return false;
+        }
+        addFace(_faces, remaining[0], remaining[1], remaining[2], ccw);
+
+        _method = Method::EarClipping;
+        return true;
+    }
+
+    const std::pmr::vector<Polygon::Face>& Polygon::triangulateCdt() {
+        _faces.clear();
+
         std::vector<p2t::Point*> pointers;
         pointers.reserve(points.size());
 
@@ -29,9 +191,37 @@ namespace infd::generator::meshbuilding {
             pointers.push_back(&point);
         }
 
-        polygon = std::make_unique<p2t::CDT>(pointers);
+        p2t::CDT cdt(pointers);
+        cdt.Triangulate();
+
+        std::vector<p2t::Triangle*> triangles = cdt.GetTriangles();
+        _faces.reserve(triangles.size());
+        for (p2t::Triangle* tri : triangles) {
+            Face face{};
+            bool inside = true;
+            for (unsigned int i = 0; i < 3; i++) {
+                face[i] = static_cast<unsigned int>(tri->GetPoint(i) - points.data());
+                inside = inside && tri->GetPoint(i) >= points.data() && face[i] < points.size();
+            }
+
+            // Degenerate input can leak triangles to the sweep's bounding points, which are no part of the polygon.
+            if (inside) _faces.push_back(face);
+        }
+
+        // The points keep the CDT's edges, which go with it.
+        for (p2t::Point& point : points) {
+            point.edge_list.clear();
+        }
+
+        _method = Method::Cdt;
+        return _faces;
+    }
+
+    Polygon::Method Polygon::method() const {
+        return _method;
+    }
 
-        polygon->Triangulate();
-        return polygon->GetTriangles();
+    Triangle Polygon::convert(const Face& face, glm::vec3 yValues, glm::vec2 pos) const {
+        return Triangle::convertTo(points[face[0]], points[face[1]], points[face[2]], yValues, pos);
     }
-}
\ No newline at end of file
+}
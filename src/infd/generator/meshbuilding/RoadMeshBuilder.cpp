@@ -3,80 +3,117 @@
 #include "infd/generator/meshbuilding/Polygon.hpp"
 
 #include "infd/generator/ChunkGenerator.hpp"
-#include "infd/util/Function.hpp"
+#include "infd/generator/util/parallel.hpp"
 
 #include <poly2tri/poly2tri.h>
 
+#include <algorithm>
+#include <limits>
+
 
 namespace infd::generator::meshbuilding {
 
-    RoadMeshBuilder::RoadMeshBuilder(ChunkGenerator& generator) :
-        x(generator.x), y(generator.y), noise(generator.perlinNoise), nodes(generator.nodes) {}
+    RoadMeshBuilder::RoadMeshBuilder(ChunkGenerator& generator, std::pmr::memory_resource* resource) :
+        heightfield(generator.heightfield), graph(generator.graph), resource(resource) {}
+
+    MeshData RoadMeshBuilder::build() {
+        MeshData data;
+        build(data, std::numeric_limits<size_t>::max()).run();
+        return data;
+    }
 
-    RoadMeshBuilder::Result RoadMeshBuilder::build() {
-        index = 0;
+    helpers::Steps RoadMeshBuilder::build(MeshData& data, size_t batch) {
+        std::pmr::vector<ScratchMesh> nodes(graph.size(), resource);
+        for (size_t begin = 0, count; begin < nodes.size(); begin += count) {
+            count = std::min(batch, nodes.size() - begin);
+            helpers::parallelFor(count, [&](size_t i) {
+                generateNode(static_cast<NodeIndex>(begin + i), nodes[begin + i]);
+            });
+            co_yield helpers::pause;
+        }
 
-        for (std::shared_ptr<Node>& node : nodes) {
-            generateNode(*node);
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        size_t triangleCount = 0;
+        for (const ScratchMesh& node : nodes) {
+            vertexCount += node.vertices.size();
+            indexCount += node.indices.size();
+            triangleCount += node.collision.size();
         }
 
-        return Result{mb.build(), std::move(tri_mesh)};
+        data = ScratchMesh::allocate(vertexCount, indexCount, triangleCount);
+        for (const ScratchMesh& node : nodes) {
+            node.appendTo(data);
+        }
     }
 
-    void RoadMeshBuilder::generateNode(Node &node) {
+    void RoadMeshBuilder::generateNode(NodeIndex node, ScratchMesh& out) {
+        size_t degree = graph.degree[node];
+
+        // An isolated root has nothing to draw.
+        if (degree == 0) return;
+
         //If it only has one edge, no need to generate the adaptive join geometry.
-        if (node.neighbours.size() == 1) {
-            generateSegment(node.neighbours[0], 0);
+        if (degree == 1) {
+            out.reserve(6, 2);
+            generateSegment(graph.edgesBegin(node), 0, out);
             return;
         }
 
-        generateIntersection(node);
+        // Six triangles a segment, two of them the colliding road, and at most two corners of the intersection per
+        // edge, each with a wall of two triangles and a colliding triangle of the floor.
+        out.reserve(12 * degree, 4 * degree);
+        generateIntersection(node, out);
     }
 
-    void RoadMeshBuilder::generateIntersection(Node &node) {
-        std::vector<Offset> offsets;
-        std::vector<Edge>& edges = node.neighbours;
+    void RoadMeshBuilder::generateIntersection(NodeIndex node, ScratchMesh& out) {
+        std::pmr::vector<Offset> offsets(resource);
+        offsets.reserve(graph.degree[node]);
+
+        // Edges of a node are contiguous and sorted by angle.
+        EdgeIndex first = graph.edgesBegin(node);
+        EdgeIndex last = graph.edgesEnd(node) - 1;
+        const float* angles = graph.edgeAngle.data();
 
-        for (unsigned int i = 0; i < edges.size()-1; i++) {
-            emplaceOffset(edges[i], edges[i+1], edges[i+1].angle - edges[i].angle, offsets);
+        for (EdgeIndex e = first; e < last; e++) {
+            emplaceOffset(angles[e], angles[e+1] - angles[e], offsets);
         }
         emplaceOffset(
-                edges.back(),
-                edges.front(),
-                edges.front().angle - edges.back().angle + glm::two_pi<float>(),
+                angles[last],
+                angles[first] - angles[last] + glm::two_pi<float>(),
                 offsets
         );
 
         for (unsigned int i = 1; i < offsets.size(); i++) {
-            generateSegment(edges[i], std::max(offsets[i].tangent, offsets[i-1].tangent));
+            generateSegment(first+i, std::max(offsets[i].tangent, offsets[i-1].tangent), out);
         }
-        generateSegment(edges.front(), std::max(offsets.back().tangent, offsets.front().tangent));
+        generateSegment(first, std::max(offsets.back().tangent, offsets.front().tangent), out);
 
-        Polygon output;
+        Polygon output(resource);
+        output.reserve(2 * offsets.size());
 
-        for (unsigned int i = 0; i < edges.size()-1; i++) {
-            emplaceVertex(offsets[i], offsets[i+1], edges[i+1], output);
+        for (unsigned int i = 0; i < offsets.size()-1; i++) {
+            emplaceVertex(offsets[i], offsets[i+1], angles[first+i+1], output);
         }
-        emplaceVertex(offsets.back(), offsets.front(), edges.front(), output);
+        emplaceVertex(offsets.back(), offsets.front(), angles[first], output);
 
-        float height = PERLIN_TERRAIN_FACTOR * ChunkGenerator::scaledPerlin(node.x+x, node.y+y, noise) + ROAD_HEIGHT;
+        float height = heightfield.sample(graph.x[node], graph.y[node]) + ROAD_HEIGHT;
 
         for (unsigned int i = 0; i < output.points.size()-1; i++) {
-            processIntersectionWall(output.points[i], output.points[i+1], height, node);
+            processIntersectionWall(output.points[i], output.points[i+1], height, node, out);
         }
-        processIntersectionWall(output.points.back(), output.points.front(), height, node);
+        processIntersectionWall(output.points.back(), output.points.front(), height, node, out);
 
-        std::vector<p2t::Triangle*> mesh = output.triangulate();
-
-        for (p2t::Triangle* tri : mesh) {
-            Triangle t = Triangle::convertTo(*tri, glm::vec3(height), glm::vec2(node.x, node.y));
-            drawCollidingTriangle(t);
+        for (const Polygon::Face& face : output.triangulate()) {
+            Triangle t = output.convert(face, glm::vec3(height), glm::vec2(graph.x[node], graph.y[node]));
+            out.drawColliding(t);
         }
     }
 
-    void RoadMeshBuilder::generateSegment(Edge &edge, float offset) {
-        Node& to = *edge.to;
-        Node& from = *edge.from;
+    void RoadMeshBuilder::generateSegment(EdgeIndex edge, float offset, ScratchMesh& out) {
+        glm::vec2 to(graph.x[graph.edgeTo[edge]], graph.y[graph.edgeTo[edge]]);
+        glm::vec2 from(graph.x[graph.edgeFrom[edge]], graph.y[graph.edgeFrom[edge]]);
+        float angle = graph.edgeAngle[edge];
 
         glm::vec2 midPoint(
                 (from.x + to.x)/2,
@@ -84,36 +121,36 @@ namespace infd::generator::meshbuilding {
         );
 
         glm::vec2 basis(
-                from.x + sin(edge.angle) * offset,
-                from.y + cos(edge.angle) * offset
+                from.x + sin(angle) * offset,
+                from.y + cos(angle) * offset
         );
 
-        float basisHeight = PERLIN_TERRAIN_FACTOR * ChunkGenerator::scaledPerlin(from.x+x, from.y+y, noise) + ROAD_HEIGHT;
-        float midPointHeight = PERLIN_TERRAIN_FACTOR * ChunkGenerator::scaledPerlin(midPoint.x+x, midPoint.y+y, noise) + ROAD_HEIGHT;
+        float basisHeight = heightfield.sample(from.x, from.y) + ROAD_HEIGHT;
+        float midPointHeight = heightfield.sample(midPoint.x, midPoint.y) + ROAD_HEIGHT;
 
         glm::vec3 xy1(
-                basis.x + sin(edge.angle+glm::half_pi<float>())*ROAD_WIDTH,
+                basis.x + sin(angle+glm::half_pi<float>())*ROAD_WIDTH,
                 basisHeight,
-                basis.y + cos(edge.angle+glm::half_pi<float>())*ROAD_WIDTH
+                basis.y + cos(angle+glm::half_pi<float>())*ROAD_WIDTH
         );
         glm::vec3 xy2(
-                basis.x + sin(edge.angle-glm::half_pi<float>())*ROAD_WIDTH,
+                basis.x + sin(angle-glm::half_pi<float>())*ROAD_WIDTH,
                 basisHeight,
-                basis.y + cos(edge.angle-glm::half_pi<float>())*ROAD_WIDTH
+                basis.y + cos(angle-glm::half_pi<float>())*ROAD_WIDTH
         );
         glm::vec3 xy3(
-                midPoint.x + sin(edge.angle-glm::half_pi<float>())*ROAD_WIDTH,
+                midPoint.x + sin(angle-glm::half_pi<float>())*ROAD_WIDTH,
                 midPointHeight,
-                midPoint.y + cos(edge.angle-glm::half_pi<float>())*ROAD_WIDTH
+                midPoint.y + cos(angle-glm::half_pi<float>())*ROAD_WIDTH
         );
         glm::vec3 xy4(
-                midPoint.x + sin(edge.angle+glm::half_pi<float>())*ROAD_WIDTH,
+                midPoint.x + sin(angle+glm::half_pi<float>())*ROAD_WIDTH,
                 midPointHeight,
-                midPoint.y + cos(edge.angle+glm::half_pi<float>())*ROAD_WIDTH
+                midPoint.y + cos(angle+glm::half_pi<float>())*ROAD_WIDTH
         );
 
-        auto drawCollisionFunc = util::BindedMemberFunc(&RoadMeshBuilder::drawCollidingTriangle, *this);
-        auto drawFunc = util::BindedMemberFunc(&RoadMeshBuilder::drawTriangle, *this);
+        auto drawCollisionFunc = [&out](Triangle& tri) { out.drawColliding(tri); };
+        auto drawFunc = [&out](Triangle& tri) { out.draw(tri); };
 
         processQuad(xy1, xy2, xy3, xy4, drawCollisionFunc);
 
@@ -133,44 +170,31 @@ namespace infd::generator::meshbuilding {
         return ROAD_WIDTH / tan(angle);
     }
 
-    void RoadMeshBuilder::emplaceOffset(Edge &a, Edge &b, float angle, std::vector<Offset> &offsets) {
+    void RoadMeshBuilder::emplaceOffset(float basisAngle, float angle, std::pmr::vector<Offset> &offsets) {
         float midAngle = angle/2;
 
         offsets.emplace_back(
-                calculateIntersection(a.angle, midAngle),
+                calculateIntersection(basisAngle, midAngle),
                 calculateTangent(midAngle),
                 midAngle
         );
     }
 
-    void RoadMeshBuilder::emplaceVertex(RoadMeshBuilder::Offset &a, RoadMeshBuilder::Offset &b, Edge &edge, Polygon& output) {
+    void RoadMeshBuilder::emplaceVertex(RoadMeshBuilder::Offset &a, RoadMeshBuilder::Offset &b, float edgeAngle, Polygon& output) {
         glm::vec2 p;
         if (a.tangent > b.tangent) {
-            p = calculateIntersection(edge.angle, a.midAngle);
+            p = calculateIntersection(edgeAngle, a.midAngle);
         } else {
-            p = calculateIntersection(edge.angle, -b.midAngle, true);
+            p = calculateIntersection(edgeAngle, -b.midAngle, true);
         }
 
         output.addPoint(a.cull);
         output.addPoint(p);
     }
 
-    void RoadMeshBuilder::processTriangle(Triangle &triangle) {
-        triangle.addToMesh(mb, index);
-    }
-
-    void RoadMeshBuilder::processIntersectionWall(p2t::Point &a, p2t::Point &b, float height,  Node &node) {
-        auto drawFunc = util::BindedMemberFunc(&RoadMeshBuilder::drawTriangle, *this);
-        processVerticalWall(glm::vec3(a.x+node.x, height, a.y+node.y),
-                            glm::vec3(b.x+node.x, height, b.y+node.y), -2*ROAD_HEIGHT, drawFunc);
-    }
-
-    void RoadMeshBuilder::drawTriangle(Triangle &tri) {
-        tri.addToMesh(mb, index);
-    }
-
-    void RoadMeshBuilder::drawCollidingTriangle(Triangle &tri) {
-        tri.addToMesh(mb, index);
-        tri.addToCollision(*tri_mesh);
+    void RoadMeshBuilder::processIntersectionWall(p2t::Point &a, p2t::Point &b, float height, NodeIndex node, ScratchMesh& out) {
+        auto drawFunc = [&out](Triangle& tri) { out.draw(tri); };
+        processVerticalWall(glm::vec3(a.x+graph.x[node], height, a.y+graph.y[node]),
+                            glm::vec3(b.x+graph.x[node], height, b.y+graph.y[node]), -2*ROAD_HEIGHT, drawFunc);
     }
 }
\ No newline at end of file
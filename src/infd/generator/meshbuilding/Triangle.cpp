@@ -13,17 +13,7 @@ namespace infd::generator::meshbuilding {
         c(c),
         norm(glm::normalize(glm::cross(a - b, a - c))) {}
 
-    void Triangle::addToMesh(GLMeshBuilder &mb, unsigned int &index) {
-        mb.vertices.emplace_back(a, norm);
-        mb.vertices.emplace_back(b, norm);
-        mb.vertices.emplace_back(c, norm);
-
-        mb.indices.push_back(index++);
-        mb.indices.push_back(index++);
-        mb.indices.push_back(index++);
-    }
-
-    void Triangle::addToCollision(btTriangleMesh &tri_mesh) {
+    void Triangle::addToCollision(btTriangleMesh &tri_mesh) const {
         tri_mesh.addTriangle(
                 math::toBullet(a),
                 math::toBullet(b),
@@ -31,12 +21,12 @@ namespace infd::generator::meshbuilding {
         );
     }
 
-    Triangle Triangle::convertTo(p2t::Triangle &tri, glm::vec3 yValues, glm::vec2 pos) {
+    Triangle Triangle::convertTo(const p2t::Point& p0, const p2t::Point& p1, const p2t::Point& p2, glm::vec3 yValues, glm::vec2 pos) {
         // p2t::Triangle winding is cw, Triangle is ccw, therefore reversed indices
         return {
-                glm::vec3(tri.GetPoint(2)->x + pos.x, yValues.x, tri.GetPoint(2)->y + pos.y),
-                glm::vec3(tri.GetPoint(1)->x + pos.x, yValues.y, tri.GetPoint(1)->y + pos.y),
-                glm::vec3(tri.GetPoint(0)->x + pos.x, yValues.z, tri.GetPoint(0)->y + pos.y)
+                glm::vec3(p2.x + pos.x, yValues.x, p2.y + pos.y),
+                glm::vec3(p1.x + pos.x, yValues.y, p1.y + pos.y),
+                glm::vec3(p0.x + pos.x, yValues.z, p0.y + pos.y)
         };
     }
 }
\ No newline at end of file
@@ -14,6 +14,33 @@
 #include <infd/render/Renderer.hpp>
 #include <infd/Wavefront.hpp>
 
+namespace {
+    // binds the item's height texture to unit 2, where the vertex shaders look for it
+    void sendDisplacement(GLint displaced, GLint skirt_depth, const infd::render::RenderComponent& item) {
+        using infd::render::sendUniform;
+
+        const auto& displacement = item.displacement;
+        sendUniform(displaced, (int)displacement.heights.has_value());
+        if (!displacement.heights) return;
+
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, *displacement.heights);
+        // the passes' own scoped binds expect unit 0 to be active
+        glActiveTexture(GL_TEXTURE0);
+        sendUniform(skirt_depth, displacement.skirt_depth);
+    }
+}
+
+infd::render::Pipeline::ItemUniforms::ItemUniforms(const GLProgram& shader) :
+        model_matrix(glGetUniformLocation(shader, "uModelMatrix")),
+        displaced(glGetUniformLocation(shader, "uDisplaced")),
+        skirt_depth(glGetUniformLocation(shader, "uSkirtDepth")),
+        colour(glGetUniformLocation(shader, "uColour")),
+        two_tone(glGetUniformLocation(shader, "uTwoTone")),
+        secondary_colour(glGetUniformLocation(shader, "uSecondaryColour")),
+        shininess(glGetUniformLocation(shader, "uShininess")),
+        flat_shading(glGetUniformLocation(shader, "uFlatShading")) {}
+
 infd::render::Pipeline::Pipeline() : _sky_sphere{loadWavefrontCases(CGRA_SRCDIR + std::string("/res/assets/sky_sphere.obj")).build()} {
     loadShaders();
     // load dither texture
@@ -85,8 +112,12 @@ void infd::render::Pipeline::render(util::handle_vector<RenderComponent*>& items
         sendUniform(_shadow_shader, "uProjectionMatrix", shadow_proj);
         sendUniform(_shadow_shader, "uViewMatrix", shadow_view);
 
+        sendUniform(_shadow_shader, "uHeights", 2);
+
         for (auto& item : items) {
-            sendUniform(_shadow_shader, "uModelMatrix", item->transform().globalTransform());
+            if (!item->material.casts_shadows) continue;
+            sendUniform(_shadow_uniforms.model_matrix, item->transform().globalTransform());
+            sendDisplacement(_shadow_uniforms.displaced, _shadow_uniforms.skirt_depth, *item);
             item->mesh.draw();
         }
     }
@@ -114,10 +145,17 @@ void infd::render::Pipeline::render(util::handle_vector<RenderComponent*>& items
         sendUniform(_main_shader, "uShadowTex", 0);
         sendUniform(_main_shader, "uShadowMatrix", shadow_proj * shadow_view);
 
+        sendUniform(_main_shader, "uHeights", 2);
+
         for (auto& item : items) {
-            sendUniform(_main_shader, "uModelMatrix", item->transform().globalTransform());
-            sendUniform(_main_shader, "uColour", item->material.colour);
-            sendUniform(_main_shader, "uShininess", item->material.shininess);
+            const auto& material = item->material;
+            sendUniform(_main_uniforms.model_matrix, item->transform().globalTransform());
+            sendDisplacement(_main_uniforms.displaced, _main_uniforms.skirt_depth, *item);
+            sendUniform(_main_uniforms.colour, material.colour);
+            sendUniform(_main_uniforms.two_tone, (int)material.secondary_colour.has_value());
+            if (material.secondary_colour) sendUniform(_main_uniforms.secondary_colour, *material.secondary_colour);
+            sendUniform(_main_uniforms.shininess, material.shininess);
+            sendUniform(_main_uniforms.flat_shading, (int)material.flat_shading);
             item->mesh.draw();
         }
     }
@@ -196,11 +234,13 @@ void infd::render::Pipeline::loadShaders() {
     main_shader_build.setShader(GL_VERTEX_SHADER, CGRA_SRCDIR + std::string("//res//shaders//phong_vert.glsl"));
     main_shader_build.setShader(GL_FRAGMENT_SHADER, CGRA_SRCDIR + std::string("//res//shaders//phong_frag.glsl"));
     _main_shader = main_shader_build.build();
+    _main_uniforms = ItemUniforms(_main_shader);
 
     ShaderBuilder shadow_build;
     shadow_build.setShader(GL_VERTEX_SHADER, CGRA_SRCDIR + std::string("//res//shaders//shadow_vert.glsl"));
     shadow_build.setShader(GL_FRAGMENT_SHADER, CGRA_SRCDIR + std::string("//res//shaders//shadow_frag.glsl"));
     _shadow_shader = shadow_build.build();
+    _shadow_uniforms = ItemUniforms(_shadow_shader);
 
     ShaderBuilder dither_build;
     dither_build.setShader(GL_VERTEX_SHADER, CGRA_SRCDIR + std::string("//res//shaders//fullscreen_vert.glsl"));
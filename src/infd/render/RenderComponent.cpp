@@ -2,14 +2,29 @@
 
 #include "infd/util/exceptions.hpp"
 #include "imgui.h"
+#include <algorithm>
 #include <utility>
 
 namespace infd::render {
     RenderComponent::RenderComponent(Renderer& renderer, const GLMesh& mesh) :
-        mesh(mesh), _hook(renderer.addRenderComponent(*this)) {}
+        mesh(mesh), _renderer(renderer), _hook(renderer.addRenderComponent(*this)) {}
 
     RenderComponent::RenderComponent(Renderer& renderer, GLMesh&& mesh) :
-        mesh(std::move(mesh)), _hook(renderer.addRenderComponent(*this)) {}
+        mesh(std::move(mesh)), _renderer(renderer), _hook(renderer.addRenderComponent(*this)) {}
+
+    bool RenderComponent::visible() const {
+        return _hook.is_owning();
+    }
+
+    void RenderComponent::visible(bool value) {
+        if (value == visible()) return;
+
+        if (value) {
+            _hook = _renderer.addRenderComponent(*this);
+        } else {
+            _hook.destroy_element();
+        }
+    }
 
     void DirectionalLightComponent::onAttach() {
         Component::onAttach();
@@ -43,8 +58,12 @@ namespace infd::render {
         return glm::lookAt(pos, pos + forward(), {0, 1, 0});
     }
 
+    float CameraComponent::nearPlane() const {
+        return std::max(min_near_plane, far_plane / max_depth_ratio);
+    }
+
     glm::mat4 CameraComponent::proj(glm::vec2 window_size) const {
-        return glm::perspective(fov, window_size.x / window_size.y, 0.1f, 1000.f);
+        return glm::perspective(fov, window_size.x / window_size.y, nearPlane(), far_plane);
     }
 
     void CameraComponent::gui() {
@@ -86,7 +86,25 @@ namespace infd::scene::physics {
 		internalFindPhysicsContext();
 		internalFindCollisionBound();
 		internalInitializeRigidBody();
-		_life_span_handle = physicsContext().internalAddRigidBody(*this);
+		if (_simulated)
+			_life_span_handle = physicsContext().internalAddRigidBody(*this);
+	}
+
+	bool RigidBody::simulated() const noexcept {
+		return _simulated;
+	}
+
+	void RigidBody::simulated(bool value) noexcept {
+		if (value == _simulated) return;
+		_simulated = value;
+
+		// not awakened yet, onAwake picks the flag up
+		if (!_physics_context) return;
+
+		if (value)
+			_life_span_handle = _physics_context->internalAddRigidBody(*this);
+		else
+			_life_span_handle.destroy_element();
 	}
 
 	void RigidBody::onDetach() {
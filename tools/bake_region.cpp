@@ -0,0 +1,174 @@
+// Pre-populates the chunk cache for a square region, so the game maps those chunks in instead of generating them.
+// Afterwards, a sample of the region is both loaded and generated again on one thread, to compare the two.
+//
+// usage: bake_region [seed] [radius] [centre x] [centre y] [directory]
+//
+// The directory defaults to $INFD_CHUNK_CACHE, which is where the game looks too, or else ./chunk_cache.
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// bullet
+#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+
+// project - generator
+#include <infd/generator/ChunkCache.hpp>
+#include <infd/generator/ChunkData.hpp>
+#include <infd/generator/ChunkFile.hpp>
+#include <infd/generator/PerlinNoise.hpp>
+#include <infd/generator/meshbuilding/PerlinMesh.hpp>
+
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using namespace infd::generator;
+
+    // Chunks compared between loading and generating.
+    const size_t COMPARE_SAMPLE = 64;
+
+    struct Coordinate {
+        int x;
+        int y;
+    };
+
+    double microseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    // Does what attaching a chunk does with the file short of GL and the scene: reads every vertex and index, as
+    // the upload would, and creates a collision shape around each prebuilt BVH.
+    std::uint64_t touch(const ChunkFile& file) {
+        std::uint64_t checksum = 0;
+
+        auto touchMesh = [&checksum](const ChunkFile::Mesh& mesh) {
+            for (size_t i = 0; i < mesh.vertexCount; i++) checksum += static_cast<std::uint64_t>(mesh.vertices[i].pos.y * 1000.f);
+            for (size_t i = 0; i < mesh.indexCount; i++) checksum += mesh.indices[i];
+
+            if (!mesh.collision) return;
+            btBvhTriangleMeshShape shape(mesh.collision.get(), true, false);
+            shape.setOptimizedBvh(mesh.bvh);
+            checksum += static_cast<std::uint64_t>(shape.getMeshInterface()->getNumSubParts());
+        };
+
+        // All attaching does on the CPU for the terrain, which is drawn from a grid shared by every chunk.
+        checksum += static_cast<std::uint64_t>(meshbuilding::terrainSkirtDepth(file.heightfield) * 1000.f);
+
+        touchMesh(file.roads);
+        for (const ChunkFile::Mesh& building : file.buildings) touchMesh(building);
+        return checksum;
+    }
+
+    // The same, for a chunk that isn't cached: generated, serialised and read back, as ChunkWorkerPool does.
+    std::unique_ptr<ChunkFile> generate(int x, int y, unsigned int seed, PerlinNoise& noise) {
+        std::atomic<bool> cancelled = false;
+        ChunkData data(x, y, seed, noise, cancelled);
+        return ChunkFile::open(ChunkFile::serialize(data));
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned int seed = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 0;
+    int radius = argc > 2 ? std::atoi(argv[2]) : 3;
+    int centreX = argc > 3 ? std::atoi(argv[3]) : 0;
+    int centreY = argc > 4 ? std::atoi(argv[4]) : 0;
+
+    const char* environment = std::getenv("INFD_CHUNK_CACHE");
+    std::filesystem::path directory = argc > 5 ? argv[5] : environment ? environment : "chunk_cache";
+
+    ChunkCache cache(directory, seed);
+    PerlinNoise noise(seed);
+
+    std::vector<Coordinate> region;
+    for (int x = centreX - radius; x <= centreX + radius; x++) {
+        for (int y = centreY - radius; y <= centreY + radius; y++) {
+            region.push_back({x, y});
+        }
+    }
+
+    std::printf("seed %u, %zu chunks around (%d, %d), in %s\n\n", seed, region.size(), centreX, centreY, cache.directory().string().c_str());
+
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> cached = 0;
+    std::atomic<size_t> failed = 0;
+    std::atomic<std::uint64_t> written = 0;
+
+    unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    Clock::time_point bakeStart = Clock::now();
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < threadCount; i++) {
+        threads.emplace_back([&] {
+            std::atomic<bool> cancelled = false;
+
+            for (size_t index = next++; index < region.size(); index = next++) {
+                auto [x, y] = region[index];
+                if (cache.load(x, y)) {
+                    cached++;
+                    continue;
+                }
+
+                ChunkData data(x, y, seed, noise, cancelled);
+                ChunkFile::Buffer bytes = ChunkFile::serialize(data);
+
+                if (cache.store(x, y, bytes)) {
+                    written += bytes.size();
+                } else {
+                    failed++;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    double bakeSeconds = std::chrono::duration<double>(Clock::now() - bakeStart).count();
+    std::printf("baked %zu chunks (%zu already cached, %zu failed) in %.2f s on %u threads, %.1f MiB written\n",
+                region.size() - cached - failed, cached.load(), failed.load(), bakeSeconds, threadCount,
+                static_cast<double>(written) / (1024 * 1024));
+
+    if (failed > 0) return 1;
+
+    // A spread out sample, so large regions don't take twice as long.
+    size_t step = std::max<size_t>(region.size() / COMPARE_SAMPLE, 1);
+    std::vector<Coordinate> sample;
+    for (size_t i = 0; i < region.size() && sample.size() < COMPARE_SAMPLE; i += step) sample.push_back(region[i]);
+
+    Clock::duration loadTime{};
+    Clock::duration generateTime{};
+    std::uint64_t loadChecksum = 0;
+    std::uint64_t generateChecksum = 0;
+
+    for (auto [x, y] : sample) {
+        Clock::time_point start = Clock::now();
+        std::unique_ptr<ChunkFile> file = cache.load(x, y);
+        if (!file) {
+            std::printf("chunk (%d, %d) could not be loaded back\n", x, y);
+            return 1;
+        }
+        loadChecksum += touch(*file);
+        loadTime += Clock::now() - start;
+
+        start = Clock::now();
+        file = generate(x, y, seed, noise);
+        generateChecksum += touch(*file);
+        generateTime += Clock::now() - start;
+    }
+
+    auto count = static_cast<double>(sample.size());
+    double load = microseconds(loadTime) / count;
+    double generate = microseconds(generateTime) / count;
+
+    std::printf("\nper chunk over %zu chunks: load %.1f us, generate %.1f us, %.1fx faster\n", sample.size(), load, generate, generate / load);
+    std::printf("loaded and generated chunks %s\n", loadChecksum == generateChecksum ? "match" : "DIFFER");
+
+    return loadChecksum == generateChecksum ? 0 : 1;
+}